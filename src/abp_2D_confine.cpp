@@ -0,0 +1,133 @@
+/*
+ * Author: Jeremy Vachier
+ * Purpose: ABP quasi-2D confine in a disk using an Euler-Mayurama algorithm
+ * Language: C++
+ * Date: 2023
+ * Same parameter.txt as abp_3D_confine (height is not used), only x, y and
+ * the angle of the orientation on the circle are integrated.
+ */
+#include <omp.h>
+#include <time.h>
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <cmath>
+
+#include "headers/print_file.h"
+#include "headers/circular_reflective_boundary_conditions.h"
+#include "headers/initialization.h"
+#include "headers/update_position_2D.h"
+#include "headers/cell_grid.h"
+
+#define N_thread 6
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  // File
+  FILE *datacsv;
+  FILE *parameter;
+  parameter = fopen("parameter.txt", "r");
+  datacsv = fopen("./data/simulation_2D.csv", "w");
+
+  // check if the file parameter is exist
+  if (parameter == NULL) {
+    printf("no such file.");
+    return 0;
+  }
+
+  omp_set_num_threads(N_thread);
+
+  // read the parameters from the file
+  double epsilon, delta, Dt, De, vs;
+  double Wall, height;
+  int Particles;
+  int N;  // number of iterations
+
+  fscanf(parameter, "%lf\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\n", \
+    &epsilon, &delta, &Particles, &Dt, &De, &vs, &Wall, &height, &N);
+  printf("%lf\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\n", \
+    epsilon, delta, Particles, Dt, De, vs, Wall);
+
+  // Position
+  double *x = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));  // x-position
+  double *y = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));  // y-position
+
+  // Orientation, e = (cos(theta), sin(theta))
+  double *theta = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));
+
+  // Interactions
+  double *F = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));
+
+  // parameters
+  const int L = 1.0;  // particle size
+
+  // seed of the counter-based noise, the generator only draws the initial
+  // state
+  random_device rdev;
+  uint64_t seed = (static_cast<uint64_t>(rdev()) << 32) | rdev();
+  default_random_engine generator(seed);
+
+  // Distribution Uniform for initialization
+  uniform_real_distribution<double> distribution(-Wall, Wall);
+
+  double prefactor_e = sqrt(2.0 * delta * De);
+  double prefactor_xi_p = sqrt(2.0 * delta * Dt);
+  double prefactor_interaction = epsilon * 48.0;
+  double r = 5.0 * L;
+
+  // cells of side r over the disk
+  cell_grid<2> grid;
+  double lower[2] = {-Wall, -Wall}, upper[2] = {Wall, Wall};
+  cell_grid_setup(grid, lower, upper, r);
+
+  // Open MP to get execution time
+  double itime, ftime, exec_time;
+  itime = omp_get_wtime();
+
+  fprintf(datacsv, "Particles,x-position,y-position, "\
+    "ex-orientation,ey-orientation,time\n");
+
+  // initialization position and activity
+  initialization_2D(
+    x, y, theta, Particles, L,
+    generator, distribution);
+  printf("Initialization done.\n");
+  printf("Seed %llu\n", static_cast<unsigned long long>(seed));
+
+  // Time evoultion
+  for (int time = 0; time < N; time++) {
+    update_position_2D(
+      x, y, theta, F, prefactor_e, Particles,
+      delta, vs, prefactor_xi_p,
+      r, prefactor_interaction, grid,
+      seed, time);
+
+    circular_reflective_boundary_conditions(
+      x, y, Particles, Wall);
+
+    if (time % 10 == 0 && time >= 0) {
+      print_file_2D(
+        x, y, theta,
+        Particles, time,
+        datacsv);
+      }
+    }
+
+  ftime = omp_get_wtime();
+  exec_time = ftime - itime;
+  printf("Time taken is %f", exec_time);
+
+  free(x);
+  free(y);
+  free(theta);
+  free(F);
+
+  fclose(datacsv);
+  return 0;
+}
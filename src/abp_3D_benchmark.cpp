@@ -0,0 +1,247 @@
+/*
+ * Author: Jeremy Vachier
+ * Purpose: Standard benchmark scenarios of the ABP 3D confine kernels
+ * Language: C++
+ * Date: 2023
+ * Usage: ./abp_3D_benchmark.out [scenario|all] [--record] [--machine=<name>]
+ *   [--layout=soa|aosoa] [--integrator=<variant>]
+ * Runs the named scenarios (headers/benchmark_scenarios.h) and compares the
+ * throughput with the baselines of the machine, on all its cores, in
+ * benchmarks/baselines.csv, --record stores the new values as the baselines
+ * of the machine.
+ * --layout=aosoa runs the kernels on blocks of 8 particles
+ * (headers/particle_layout.h), its baselines are named <scenario>/aosoa.
+ * --integrator runs a prebuilt variant of update_position (abp_full, ...)
+ * instead of the one selected from the parameters, baselines
+ * <scenario>/<variant>.
+ */
+#include <omp.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <random>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <climits>
+
+#include "headers/benchmark_scenarios.h"
+#include "headers/cylindrical_reflective_boundary_conditions.h"
+#include "headers/update_position.h"
+#include "headers/small_system.h"
+#include "headers/cell_grid.h"
+#include "headers/particle_layout.h"
+
+#define BENCHMARK_SEED 20231
+#define BENCHMARK_BASELINES "./benchmarks/baselines.csv"
+#define BENCHMARK_BLOCK 8
+
+using namespace std;
+
+struct benchmark_baseline {
+  string scenario, machine;
+  int threads;
+  double throughput;  // particle-steps per second
+};
+
+static vector<benchmark_baseline> benchmark_read_baselines() {
+  vector<benchmark_baseline> baselines;
+  FILE *file = fopen(BENCHMARK_BASELINES, "r");
+  if (file == NULL) {
+    return baselines;
+  }
+  char line[256], scenario[64], machine[64];
+  int threads;
+  double throughput;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (sscanf(line, "%63[^,],%63[^,],%d,%lf", \
+      scenario, machine, &threads, &throughput) == 4) {
+      baselines.push_back({scenario, machine, threads, throughput});
+    }
+  }
+  fclose(file);
+  return baselines;
+}
+
+static void benchmark_write_baselines(
+  const vector<benchmark_baseline> &baselines) {
+  FILE *file = fopen(BENCHMARK_BASELINES, "w");
+  if (file == NULL) {
+    printf("cannot write %s\n", BENCHMARK_BASELINES);
+    return;
+  }
+  fprintf(file, "scenario,machine,threads,particle-steps-per-second\n");
+  for (const benchmark_baseline &baseline : baselines) {
+    fprintf(file, "%s,%s,%d,%e\n", baseline.scenario.c_str(), \
+      baseline.machine.c_str(), baseline.threads, baseline.throughput);
+  }
+  fclose(file);
+}
+
+// Particle-steps per second of the production kernels on the scenario
+static double benchmark_run(
+  const benchmark_scenario &scenario, bool aosoa,
+  const update_position_variant *variant) {
+  size_t Total = static_cast<size_t>(scenario.replicas) * scenario.Particles;
+  vector<double> x(Total), y(Total), z(Total), ex(Total), ey(Total), ez(Total);
+  benchmark_initial_state(
+    scenario, x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(),
+    BENCHMARK_SEED);
+
+  const int L = 1.0;
+  int Particles = scenario.Particles;
+  double Wall = scenario.Wall, height = scenario.height;
+  double delta = scenario.delta, vs = scenario.vs;
+  double prefactor_e = sqrt(2.0 * delta * scenario.De);
+  double prefactor_xi_p = sqrt(2.0 * delta * scenario.Dt);
+  double prefactor_interaction = scenario.epsilon * 48.0;
+  double r = 5.0 * L;
+  double lower[3] = {-Wall, -Wall, -height}, upper[3] = {Wall, Wall, height};
+
+  double itime = omp_get_wtime();
+#pragma omp parallel for schedule(dynamic) if (scenario.replicas > 1)
+  for (int n = 0; n < scenario.replicas; n++) {
+    size_t offset = static_cast<size_t>(n) * Particles;
+    double *xr = &x[offset], *yr = &y[offset], *zr = &z[offset];
+    double *exr = &ex[offset], *eyr = &ey[offset], *ezr = &ez[offset];
+    // small systems run on the compile-time engine, as in the ensembles
+    default_random_engine generator(BENCHMARK_SEED + n);
+    normal_distribution<double> Gaussdistribution(0.0, 1.0);
+    uniform_real_distribution<double> distribution_e(0.0, 1.0);
+    if (small_system_dispatch(
+      small_system_counts(), Particles, xr, yr, zr, exr, eyr, ezr,
+      scenario.steps, prefactor_e, vs, delta, prefactor_xi_p,
+      r, prefactor_interaction, Wall, height, L,
+      generator, Gaussdistribution, distribution_e)) {
+      continue;
+    }
+    cell_grid<3> grid;
+    cell_grid_setup(grid, lower, upper, r);
+    vector<double> force(2 * Particles);
+    if (aosoa) {
+      soa_layout soa = {{xr, yr, zr, exr, eyr, ezr}};
+      aosoa_layout<BENCHMARK_BLOCK> blocks = \
+        aosoa_allocate<BENCHMARK_BLOCK>(Particles);
+      aosoa_load(blocks, soa, Particles);
+      for (int time = 0; time < scenario.steps; time++) {
+        update_position_layout<abp_policies>(
+          blocks, force.data(), prefactor_e, Particles,
+          delta, vs, prefactor_xi_p, prefactor_xi_p, prefactor_xi_p,
+          r, prefactor_interaction, 0.0, INT_MAX, vs, 0, NULL, NULL, grid,
+          BENCHMARK_SEED + n, time);
+        cylindrical_reflective_boundary_conditions_layout(
+          blocks, Particles, Wall, height, L);
+      }
+      aosoa_store(blocks, soa, Particles);
+      free(blocks.data);
+      continue;
+    }
+    update_position_kernel kernel = variant != NULL ? variant->kernel \
+      : update_position;
+    for (int time = 0; time < scenario.steps; time++) {
+      kernel(
+        xr, yr, zr, exr, eyr, ezr, force.data(), prefactor_e, Particles,
+        delta, vs, prefactor_xi_p, prefactor_xi_p, prefactor_xi_p,
+        r, prefactor_interaction, 0.0, INT_MAX, vs, 0, NULL, NULL, grid,
+        BENCHMARK_SEED + n, time);
+      cylindrical_reflective_boundary_conditions(
+        xr, yr, zr, Particles, Wall, height, L);
+    }
+  }
+  double exec_time = omp_get_wtime() - itime;
+  return static_cast<double>(Total) * scenario.steps / exec_time;
+}
+
+int main(int argc, char *argv[]) {
+  const char *name = "all";
+  bool record = false, aosoa = false;
+  const update_position_variant *variant = NULL;
+  char machine[64];
+  if (gethostname(machine, sizeof(machine)) != 0) {
+    snprintf(machine, sizeof(machine), "unknown");
+  }
+  machine[sizeof(machine) - 1] = '\0';
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--record") == 0) {
+      record = true;
+    } else if (strncmp(argv[i], "--machine=", 10) == 0) {
+      snprintf(machine, sizeof(machine), "%s", argv[i] + 10);
+    } else if (strcmp(argv[i], "--layout=soa") == 0) {
+      aosoa = false;
+    } else if (strcmp(argv[i], "--layout=aosoa") == 0) {
+      aosoa = true;
+    } else if (strncmp(argv[i], "--integrator=", 13) == 0) {
+      variant = update_position_find(argv[i] + 13);
+      if (variant == NULL) {
+        printf("unknown integrator %s, one of:", argv[i] + 13);
+        for (int v = 0; v < update_position_variant_count; v++) {
+          printf(" %s", update_position_variants[v].name);
+        }
+        printf("\n");
+        return 0;
+      }
+    } else {
+      name = argv[i];
+    }
+  }
+  if (strcmp(name, "all") != 0 && benchmark_find(name) == NULL) {
+    printf("unknown scenario %s, one of: all", name);
+    for (int s = 0; s < benchmark_scenario_count; s++) {
+      printf(" %s", benchmark_scenarios[s].name);
+    }
+    printf("\n");
+    return 0;
+  }
+
+  omp_set_max_active_levels(1);
+  // all the cores of the machine, the baselines are per thread count
+  int threads = omp_get_num_procs();
+  omp_set_num_threads(threads);
+  vector<benchmark_baseline> baselines = benchmark_read_baselines();
+
+  printf("%-14s %12s %12s %8s  %s\n", "scenario", "steps/s", "baseline", \
+    "ratio", "description");
+  for (int s = 0; s < benchmark_scenario_count; s++) {
+    const benchmark_scenario &scenario = benchmark_scenarios[s];
+    if (strcmp(name, "all") != 0 && strcmp(name, scenario.name) != 0) {
+      continue;
+    }
+    double throughput = benchmark_run(scenario, aosoa, variant);
+    string key = scenario.name;
+    if (aosoa) {
+      key += "/aosoa";
+    }
+    if (variant != NULL) {
+      key += string("/") + variant->name;
+    }
+
+    benchmark_baseline *baseline = NULL;
+    for (benchmark_baseline &b : baselines) {
+      if (b.scenario == key && b.machine == machine \
+        && b.threads == threads) {
+        baseline = &b;
+      }
+    }
+    if (baseline != NULL) {
+      printf("%-14s %12.4e %12.4e %8.3f  %s\n", key.c_str(), throughput, \
+        baseline->throughput, throughput / baseline->throughput, \
+        scenario.description);
+    } else {
+      printf("%-14s %12.4e %12s %8s  %s\n", key.c_str(), throughput, \
+        "-", "-", scenario.description);
+    }
+    if (record) {
+      if (baseline != NULL) {
+        baseline->throughput = throughput;
+      } else {
+        baselines.push_back({key, machine, threads, throughput});
+      }
+    }
+  }
+
+  if (record) {
+    benchmark_write_baselines(baselines);
+    printf("Baselines of %s recorded in %s\n", machine, BENCHMARK_BASELINES);
+  }
+  return 0;
+}
@@ -14,24 +14,125 @@
 #include <cstring>
 #include <cmath>
 #include <tuple>
+#include <climits>
+#include <algorithm>
 
 #include "headers/print_file.h"
 #include "headers/cylindrical_reflective_boundary_conditions.h"
 #include "headers/initialization.h"
 #include "headers/update_position.h"
-#include "headers/check_nooverlap.h"
+#include "headers/update_position_spherocylinder.h"
+#include "headers/poisson_disk.h"
+#include "headers/output_backend.h"
+#include "headers/run_options.h"
+#include "headers/checkpoint.h"
+#include "headers/cell_grid.h"
+#include "headers/bond_order.h"
+#include "headers/chemical_field.h"
+#include "headers/bonds.h"
+#include "headers/trajectory.h"
+#include "headers/neighbour_diagnostics.h"
+#include "headers/steering.h"
+#include "headers/observer_pipeline.h"
+#include "headers/external_field.h"
+#include "headers/result_cache.h"
+#include "headers/local_time_stepping.h"
+#include "headers/flight_recorder.h"
 
 #define PI 3.141592653589793
 #define N_thread 6
 
 using namespace std;
 
+// In-situ analyses of the observer pipeline, each on its own cell grid
+// built on the snapshot
+struct bond_order_observer {
+  bond_order order;
+  cell_grid<3> grid;
+  double Wall;
+  int L;
+};
+
+static void bond_order_observe(
+  void *context, const observer_snapshot &snapshot) {
+  bond_order_observer *o = reinterpret_cast<bond_order_observer*>(context);
+  double *position[3] = {snapshot.x, snapshot.y, snapshot.z};
+  cell_grid_build(o->grid, position, snapshot.Particles);
+  bond_order_compute(
+    o->order, snapshot.x, snapshot.y, snapshot.z, snapshot.Particles,
+    1.5 * o->L, o->grid);
+  bond_order_record(
+    o->order, snapshot.x, snapshot.y, snapshot.Particles, o->Wall, o->L,
+    snapshot.time);
+}
+
+struct diagnostics_observer {
+  neighbour_diagnostics diagnostics;
+  cell_grid<3> grid;
+  double cutoff;
+};
+
+static void diagnostics_observe(
+  void *context, const observer_snapshot &snapshot) {
+  diagnostics_observer *o = reinterpret_cast<diagnostics_observer*>(context);
+  neighbour_diagnostics_record(
+    o->diagnostics, snapshot.x, snapshot.y, snapshot.z, snapshot.Particles,
+    o->cutoff, o->grid, snapshot.time);
+}
+
 int main(int argc, char *argv[]) {
+  run_options options;
+  if (!parse_run_options(argc, argv, options)) {
+    return 0;
+  }
+
+  // a run already in the cache is copied from it, a longer one continues
+  // from its final checkpoint
+  result_cache cache;
+  int requested = 0;
+  string cached_checkpoint;
+  if (options.cache != NULL) {
+    if (!result_cache_open(cache, options.cache, options, requested)) {
+      options.cache = NULL;
+    } else if (cache.steps == requested) {
+      result_cache_restore(cache);
+      printf("Cache hit %s, %d steps\n", cache.directory.c_str(), \
+        cache.steps);
+      return 0;
+    } else if (cache.steps < requested && !cache.extendable) {
+      cache.steps = 0;  // integrated from the start, replaces the entry
+    } else if (cache.steps > 0 && cache.steps < requested) {
+      cached_checkpoint = result_cache_checkpoint(cache);
+      options.restart = cached_checkpoint.c_str();
+      printf("Extending %s from step %d\n", cache.directory.c_str(), \
+        cache.steps);
+    }
+  }
+
+  // a replay integrates from the checkpoint and writes every step of the
+  // window in its own file, the other outputs of the run are left as they
+  // are
+  const char *restart = options.restart;
+  char trajectory[64] = "./data/simulation.csv";
+  int output_from = 0, output_every = options.output_every;
+  if (options.replay != NULL) {
+    restart = options.replay;
+    snprintf(trajectory, sizeof(trajectory), "./data/replay_%d_%d.csv", \
+      options.window_begin, options.window_end);
+    output_from = options.window_begin;
+    output_every = 1;
+    options.checkpoint_every = 0;
+    options.trajectory_every = 0;
+    options.bond_order_every = 0;
+    options.diagnostics_every = 0;
+    options.flight_frames = 0;
+  }
+
   // File
-  FILE *datacsv;
+  output_backend datacsv;
   FILE *parameter;
   parameter = fopen("parameter.txt", "r");
-  datacsv = fopen("./data/simulation.csv", "w");
+  output_backend_open(datacsv, trajectory, options.uring_output);
 
   // check if the file parameter is exist
   if (parameter == NULL) {
@@ -51,6 +152,9 @@ int main(int argc, char *argv[]) {
     &epsilon, &delta, &Particles, &Dt, &De, &vs, &Wall, &height, &N);
   printf("%lf\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\n", \
     epsilon, delta, Particles, Dt, De, vs, Wall, height, N);
+  if (options.replay != NULL) {
+    N = options.window_end + 1;
+  }
 
   // Position
   double *x = reinterpret_cast<double*> \
@@ -71,24 +175,20 @@ int main(int argc, char *argv[]) {
   // parameters
   const int L = 1.0;  // particle size
 
-  // initialization of the random generator
+  // seed of the counter-based noise, the generator only draws the initial
+  // state
   random_device rdev;
-  default_random_engine generator(rdev());  // random seed -> rdev
+  uint64_t seed = options.seed;
+  if (seed == 0) {
+    seed = (static_cast<uint64_t>(rdev()) << 32) | rdev();
+  }
+  default_random_engine generator(seed);
 
-  // Distributions Gaussian
-  normal_distribution<double> Gaussdistribution(0.0, 1.0);
   // Distribution Uniform for initialization
   uniform_real_distribution<double> distribution(-Wall, Wall);
   // Uniform distribution for the orientation
   uniform_real_distribution<double> distribution_e(0.0, 1.0);
 
-  double xi_px = 0.0;  // noise for x-position
-  double xi_py = 0.0;  // noise for y-position
-  double xi_pz = 0.0;  // noise for z-position
-  double xi_ex = 0.0;  // noise ex ortientation
-  double xi_ey = 0.0;  // noise ey ortientation
-  double xi_ez = 0.0;  // noise ez ortientation
-
   // double phi = 0.0;
   double prefactor_e = sqrt(2.0 * delta * De);
   double prefactor_xi_px = sqrt(2.0 * delta * Dt);
@@ -97,55 +197,344 @@ int main(int argc, char *argv[]) {
   double prefactor_interaction = epsilon * 48.0;
   double r = 5.0 * L;
 
+  // forces of the step (torques too for spherocylinders)
+  double *force = reinterpret_cast<double*> \
+    (malloc(6 * Particles * sizeof(double)));
+
+  // optional spherocylinders of segment length `length` along e
+  double length = 0.0;
+  bool spherocylinders = false;
+  FILE *spherocylinder = fopen("spherocylinder.txt", "r");
+  if (spherocylinder != NULL) {
+    fscanf(spherocylinder, "%lf\n", &length);
+    fclose(spherocylinder);
+    spherocylinders = true;
+    printf("Spherocylinders of length %lf\n", length);
+  }
+
+  // cells of side r (or length + WCA cutoff for spherocylinders) over the
+  // cylinder
+  cell_grid<3> grid;
+  double lower[3] = {-Wall, -Wall, -height}, upper[3] = {Wall, Wall, height};
+  cell_grid_setup(
+    grid, lower, upper,
+    spherocylinders ? max(r, length + pow(2.0, 1.0 / 6.0) * L) : r);
+
+  // optional self-produced chemical field
+  chemical_field field;
+  FILE *chemical = fopen("chemical_field.txt", "r");
+  bool chemotaxis = chemical_field_setup(field, chemical, Wall, height, delta);
+  if (chemical != NULL) {
+    fclose(chemical);
+  }
+  // the field is part of the state of the checkpoints
+  size_t field_values = chemotaxis ? chemical_field_values(field) : 0;
+
+  // optional quorum sensing (density dependent self-propulsion)
+  double r_qs = 0.0, vs_qs = vs;
+  int N_qs = INT_MAX;
+  FILE *quorum = fopen("quorum_sensing.txt", "r");
+  if (quorum != NULL) {
+    fscanf(quorum, "%lf\t%d\t%lf\n", &r_qs, &N_qs, &vs_qs);
+    fclose(quorum);
+    r_qs = min(r_qs, r);
+    printf("Quorum sensing %lf\t%d\t%lf\n", r_qs, N_qs, vs_qs);
+  }
+  if (quorum != NULL && spherocylinders) {
+    // update_position_spherocylinder does not count the neighbours
+    printf("quorum_sensing.txt is not supported with spherocylinders\n");
+    return 0;
+  }
+
+  // optional gravity, harmonic trap, gravitactic torque and Poiseuille flow
+  external_field potentials = {};
+  FILE *external_file = fopen("external_field.txt", "r");
+  bool external = external_field_setup(potentials, external_file);
+  if (external_file != NULL) {
+    fclose(external_file);
+  }
+  FILE *flow_file = fopen("poiseuille_flow.txt", "r");
+  if (external_field_setup_flow(potentials, flow_file, Wall)) {
+    external = true;
+  }
+  if (flow_file != NULL) {
+    fclose(flow_file);
+  }
+  if (external && spherocylinders) {
+    // update_position_spherocylinder has no external forces nor flow
+    printf("external_field.txt and poiseuille_flow.txt are not supported "\
+      "with spherocylinders\n");
+    return 0;
+  }
+
+  // optional sub-stepping of the particles in close contact
+  local_time_stepping stepping = {};
+  FILE *stepping_file = fopen("local_time_stepping.txt", "r");
+  bool substeps = local_time_stepping_setup(
+    stepping, stepping_file, Particles);
+  if (stepping_file != NULL) {
+    fclose(stepping_file);
+  }
+  if (substeps && spherocylinders) {
+    // update_position_spherocylinder takes the coarse step only
+    printf("local_time_stepping.txt is not supported with spherocylinders\n");
+    return 0;
+  }
+
+  // optional chains (dumbbells, active filaments)
+  bond_list bonds;
+  bonds.beads_per_chain = 0;
+  FILE *polymer = fopen("polymer.txt", "r");
+  bool chains = bond_list_setup(bonds, polymer, Particles);
+  if (polymer != NULL) {
+    fclose(polymer);
+  }
+
+  // analyses sampled at the end of the steps, on spare threads with
+  // --observers=<threads>
+  observer_pipeline observers;
+  bond_order_observer order;
+  if (options.bond_order_every > 0) {
+    bond_order_open(order.order, Particles, "./data/bond_order.csv");
+    order.grid = grid;
+    order.Wall = Wall;
+    order.L = L;
+    observer_add(
+      observers, "bond_order", options.bond_order_every,
+      bond_order_observe, &order);
+  }
+
+  diagnostics_observer diagnostics;
+  if (options.diagnostics_every > 0) {
+    neighbour_diagnostics_open(
+      diagnostics.diagnostics, "./data/diagnostics.csv");
+    diagnostics.grid = grid;
+    diagnostics.cutoff = spherocylinders \
+      ? length + pow(2.0, 1.0 / 6.0) * L : r;
+    observer_add(
+      observers, "diagnostics", options.diagnostics_every,
+      diagnostics_observe, &diagnostics);
+  }
+
+  // parameters changed between two steps by the control server
+  steering_server server;
+  steering_parameters steered = {vs, De, epsilon, output_every};
+  if (options.steer != NULL) {
+    if (steering_open(server, options.steer)) {
+      printf("Steering on %s\n", options.steer);
+    } else {
+      printf("cannot listen on %s\n", options.steer);
+      options.steer = NULL;
+    }
+  }
+
+  trajectory_writer binary;
+  if (options.trajectory_every > 0 && !trajectory_writer_open(
+    binary, "./data/trajectory.bin", Particles, Wall, height)) {
+    options.trajectory_every = 0;
+  }
+
+  // the last steps in memory, written around rare events
+  flight_recorder recorder;
+  if (options.flight_frames > 0) {
+    flight_recorder_open(
+      recorder, options.flight_frames, Particles, options.flight_cluster,
+      Wall, height, r);
+  }
+
   // Open MP to get execution time
   double itime, ftime, exec_time;
   itime = omp_get_wtime();
 
-  fprintf(datacsv, "Particles,x-position,y-position,z-position, "\
+  output_backend_print(datacsv, "Particles,x-position,y-position,z-position, "\
     "ex-orientation,ey-orientation,ez-orientation,time\n");
 
-  // initialization position and activity
-  initialization(
-    x, y, z, ex, ey, ez, Particles,
-    generator, distribution, distribution_e);
+  int start = 0;  // first step, non zero after a restart
+  if (restart != NULL) {
+    if (!checkpoint_read(
+      restart, x, y, z, ex, ey, ez, Particles, start, seed,
+      chemotaxis ? field.c : NULL, field_values)) {
+      printf("cannot restart from %s\n", restart);
+      return 0;
+    }
+    if (options.replay != NULL && start > output_from) {
+      printf("the checkpoint (step %d) is after the window\n", start);
+      return 0;
+    }
+    printf("Restart from step %d.\n", start);
+  } else {
+    // initialization position and activity
+    initialization(
+      x, y, z, ex, ey, ez, Particles,
+      generator, distribution, distribution_e);
+
+    poisson_disk_positions(
+      x, y, z, Particles, Wall, height, L, generator);
 
-  check_nooverlap(
-    x, y, z, Particles, L,
-    generator, distribution);
-  printf("Initialization done.\n");
+    if (chains) {
+      bond_list_place(bonds, x, y, z, Wall, height, L, generator);
+    }
+    printf("Initialization done.\n");
+  }
+  printf("Seed %llu\n", static_cast<unsigned long long>(seed));
+  if (!spherocylinders) {
+    printf("Integrator %s\n", update_position_select(
+      prefactor_e, prefactor_xi_px, prefactor_interaction, N_qs,
+      bonds.beads_per_chain, external ? &potentials : NULL,
+      substeps ? &stepping : NULL)->name);
+  }
+
+  checkpoint_children children;
+  children.max_children = options.checkpoint_children;
+  children.completed = 0;
+  children.failed = 0;
+  char checkpoint_path[64];
+
+  observer_pipeline_start(
+    observers, options.observer_threads, options.observer_budget,
+    options.observer_staleness);
 
   // Time evoultion
-  for (int time = 0; time < N; time++) {
-    update_position(
-      x, y, z, ex, ey, ez, prefactor_e, Particles,
-      delta, De, Dt, xi_ex, xi_ey, xi_ez, xi_px,
-      xi_py, xi_pz, vs, prefactor_xi_px, prefactor_xi_py, prefactor_xi_pz,
-      r, prefactor_interaction,
-      generator, Gaussdistribution, distribution_e);
+  for (int time = start; time < N; time++) {
+    if (spherocylinders) {
+      update_position_spherocylinder(
+        x, y, z, ex, ey, ez, force, Particles,
+        delta, vs, prefactor_e, prefactor_xi_px,
+        length, epsilon, L, Wall, height, grid,
+        seed, time);
+    } else {
+      update_position(
+        x, y, z, ex, ey, ez, force, prefactor_e, Particles,
+        delta, vs, prefactor_xi_px, prefactor_xi_py, prefactor_xi_pz,
+        r, prefactor_interaction, r_qs, N_qs, vs_qs,
+        bonds.beads_per_chain, external ? &potentials : NULL,
+        substeps ? &stepping : NULL, grid, seed, time);
+      if (substeps) {
+        local_time_stepping_count(stepping, Particles);
+      }
+    }
+
+    if (chains) {
+      bond_list_apply(bonds, x, y, z, delta, epsilon, L);
+    }
+
+    if (chemotaxis) {
+      chemical_field_update(field, x, y, z, Particles, delta);
+      chemical_field_couple(
+        field, x, y, z, ex, ey, ez, Particles, delta);
+    }
 
     cylindrical_reflective_boundary_conditions(
       x, y, z, Particles,
       Wall, height, L);
 
-    if (time % 10 == 0 && time >= 0) {
-      print_file(
-        x, y, z, ex, ey, ez,
-        Particles, time,
-        datacsv);
+    if (options.steer != NULL && steering_poll(
+      server, steered, x, y, z, ex, ey, ez, Particles, Wall, L, time)) {
+      vs = steered.vs;
+      De = steered.De;
+      epsilon = steered.epsilon;
+      output_every = steered.output_every;
+      prefactor_e = sqrt(2.0 * delta * De);
+      prefactor_interaction = epsilon * 48.0;
+    }
+
+    if (output_every > 0 && time >= output_from \
+      && (time - output_from) % output_every == 0) {
+      output_backend_frame(
+        datacsv, x, y, z, ex, ey, ez,
+        Particles, time);
       }
+
+    if (options.trajectory_every > 0 \
+      && time % options.trajectory_every == 0) {
+      trajectory_writer_frame(
+        binary, x, y, z, ex, ey, ez, Particles, time);
+    }
+
+    if (options.flight_frames > 0 && !flight_recorder_step(
+      recorder, x, y, z, ex, ey, ez, time)) {
+      printf("The state is not finite at step %d, stop.\n", time);
+      break;
+    }
+
+    observer_pipeline_step(
+      observers, x, y, z, ex, ey, ez, Particles, time);
+
+    if (options.checkpoint_every > 0 \
+      && (time + 1) % options.checkpoint_every == 0) {
+      snprintf(checkpoint_path, sizeof(checkpoint_path), \
+        "./data/checkpoint_%d.bin", time + 1);
+      checkpoint_fork(
+        children, checkpoint_path,
+        x, y, z, ex, ey, ez, Particles, time + 1, seed,
+        chemotaxis ? field.c : NULL, field_values);
+    }
     }
 
   ftime = omp_get_wtime();
   exec_time = ftime - itime;
   printf("Time taken is %f", exec_time);
 
+  // a shorter run does not replace a longer entry
+  bool cache_store = options.cache != NULL && N > cache.steps;
+
+  // the time of the time loop, the samples still queued come after it
+  observer_pipeline_stop(observers);
+
+  if (options.checkpoint_every > 0) {
+    checkpoint_reap(children, true);
+    printf("\nCheckpoints written %d, failed %d", \
+      children.completed, children.failed);
+  }
+
+  if (substeps) {
+    printf("\nSub-stepped %ld particle-steps (%f of them)", \
+      stepping.substepped, static_cast<double>(stepping.substepped) \
+      / (static_cast<double>(Particles) * max(N - start, 1)));
+    local_time_stepping_free(stepping);
+  }
+
+  if (options.diagnostics_every > 0) {
+    neighbour_diagnostics_close(
+      diagnostics.diagnostics, "./data/diagnostics_histogram.csv");
+  }
+
+  if (options.steer != NULL) {
+    steering_close(server);
+  }
+
+  if (options.trajectory_every > 0) {
+    trajectory_writer_close(binary);
+  }
+
+  if (options.flight_frames > 0) {
+    flight_recorder_close(recorder);
+  }
+
+  if (options.bond_order_every > 0) {
+    bond_order_close(order.order, "./data/bond_order_histogram.csv");
+  }
+
+  // the entry is written only from complete outputs
+  bool written = output_backend_close(datacsv);
+  if (!written) {
+    printf("\nthe trajectories could not be written entirely\n");
+  } else if (cache_store && !result_cache_store(
+    cache, N, x, y, z, ex, ey, ez, Particles, seed,
+    chemotaxis ? field.c : NULL, field_values)) {
+    printf("\nthe run could not be stored in %s\n", cache.directory.c_str());
+  }
+
+  if (chemotaxis) {
+    chemical_field_free(field);
+  }
+
   free(x);
   free(y);
   free(z);
   free(ex);
   free(ey);
   free(ez);
-
-  fclose(datacsv);
-  return 0;
+  free(force);
+  return written ? 0 : 1;
 }
@@ -0,0 +1,245 @@
+/*
+ * Author: Jeremy Vachier
+ * Purpose: Ensemble of independent ABP 3D confine systems
+ * Language: C++
+ * Date: 2023
+ * Usage: ./abp_3D_ensemble.out [replicas] [--threads-per-replica=<t>]
+ * (parameters read from parameter.txt)
+ * Particle counts listed in small_system_counts use the compile-time engine
+ * of headers/small_system.h, the others the generic kernels.
+ * The cores are split between concurrent replicas and the threads of each
+ * replica (headers/core_partition.h): by default every split is measured
+ * for a few steps at the particle count of the run and the fastest in total
+ * particle-steps per second is used, --threads-per-replica=<t> imposes one.
+ */
+#include <omp.h>
+#include <time.h>
+#include <stdio.h>
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <climits>
+
+#include "headers/cylindrical_reflective_boundary_conditions.h"
+#include "headers/initialization.h"
+#include "headers/update_position.h"
+#include "headers/poisson_disk.h"
+#include "headers/small_system.h"
+#include "headers/cell_grid.h"
+#include "headers/core_partition.h"
+
+#define CALIBRATION_STEPS 20  // steps of each split measured
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  // File
+  FILE *datacsv;
+  FILE *parameter;
+  parameter = fopen("parameter.txt", "r");
+
+  // check if the file parameter is exist
+  if (parameter == NULL) {
+    printf("no such file.");
+    return 0;
+  }
+
+  numa_topology topology;
+  numa_topology_read(topology);
+  int Replicas = topology.cpus;
+  int threads_per_replica = 0;  // 0: calibrated
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--threads-per-replica=", 22) == 0) {
+      threads_per_replica = atoi(argv[i] + 22);
+    } else {
+      Replicas = atoi(argv[i]);
+    }
+  }
+  if (Replicas < 1) {
+    printf("Number of replicas must be positive\n");
+    return 0;
+  }
+
+  // read the parameters from the file
+  double epsilon, delta, Dt, De, vs;
+  double Wall, height;
+  int Particles;
+  int N;  // number of iterations
+
+  fscanf(parameter, "%lf\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\n", \
+    &epsilon, &delta, &Particles, &Dt, &De, &vs, &Wall, &height, &N);
+  fclose(parameter);
+  printf("%lf\t%lf\t%d\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\t%d\n", \
+    epsilon, delta, Particles, Dt, De, vs, Wall, height, N, Replicas);
+
+  datacsv = fopen("./data/ensemble.csv", "w");
+
+  // Ensemble state, replica n owns [n * Particles, (n + 1) * Particles)
+  size_t Total = static_cast<size_t>(Replicas) * Particles;
+  double *x = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // x-position
+  double *y = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // y-position
+  double *z = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // z-position
+  double *ex = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // ex-orientation
+  double *ey = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // ey-orientation
+  double *ez = reinterpret_cast<double*> \
+    (malloc(Total * sizeof(double)));  // ez-orientation
+
+  // parameters
+  const int L = 1.0;  // particle size
+  double prefactor_e = sqrt(2.0 * delta * De);
+  double prefactor_xi_p = sqrt(2.0 * delta * Dt);
+  double prefactor_interaction = epsilon * 48.0;
+  double r = 5.0 * L;
+
+  // one seed per replica, drawn before the parallel region
+  random_device rdev;
+  vector<unsigned int> seeds(Replicas);
+  for (int n = 0; n < Replicas; n++) {
+    seeds[n] = rdev();
+  }
+
+  // steps of replica n, from a new state drawn from its seed if initial,
+  // with the threads of the calling team. Returns true for the compile-time
+  // engine.
+  auto replica = [&](int n, int steps, bool initial) {
+    default_random_engine generator(seeds[n]);
+    normal_distribution<double> Gaussdistribution(0.0, 1.0);
+    uniform_real_distribution<double> distribution(-Wall, Wall);
+    uniform_real_distribution<double> distribution_e(0.0, 1.0);
+
+    size_t offset = static_cast<size_t>(n) * Particles;
+    double *xr = x + offset, *yr = y + offset, *zr = z + offset;
+    double *exr = ex + offset, *eyr = ey + offset, *ezr = ez + offset;
+
+    if (initial) {
+      initialization(
+        xr, yr, zr, exr, eyr, ezr, Particles,
+        generator, distribution, distribution_e);
+      poisson_disk_positions(
+        xr, yr, zr, Particles, Wall, height, L, generator);
+    }
+
+    bool small = small_system_dispatch(
+      small_system_counts(), Particles, xr, yr, zr, exr, eyr, ezr,
+      steps, prefactor_e, vs, delta, prefactor_xi_p,
+      r, prefactor_interaction, Wall, height, L,
+      generator, Gaussdistribution, distribution_e);
+
+    if (!small) {
+      cell_grid<3> grid;
+      double lower[3] = {-Wall, -Wall, -height};
+      double upper[3] = {Wall, Wall, height};
+      cell_grid_setup(grid, lower, upper, r);
+      vector<double> force(2 * Particles);
+      for (int time = 0; time < steps; time++) {
+        update_position(
+          xr, yr, zr, exr, eyr, ezr, force.data(), prefactor_e, Particles,
+          delta, vs, prefactor_xi_p, prefactor_xi_p, prefactor_xi_p,
+          r, prefactor_interaction, 0.0, INT_MAX, vs, 0, NULL, NULL, grid,
+          seeds[n], time);
+        cylindrical_reflective_boundary_conditions(
+          xr, yr, zr, Particles,
+          Wall, height, L);
+      }
+    }
+    return small;
+  };
+
+  // `replicas` replicas on the groups of the partition, each group pinned
+  // to its CPUs and running its replica with its own team
+  omp_set_max_active_levels(2);
+  auto run = [&](
+    const core_partition &partition, int replicas, int steps, bool initial) {
+#pragma omp parallel num_threads(min(partition.groups, replicas))
+    {
+      int g = omp_get_thread_num();
+      core_partition_pin(partition, g);
+      omp_set_num_threads(partition.threads);
+#pragma omp parallel
+      core_partition_pin(partition, g);  // reused nested threads too
+#pragma omp for schedule(dynamic)
+      for (int n = 0; n < replicas; n++) {
+        replica(n, steps, initial);
+      }
+    }
+  };
+
+  vector<core_partition> candidates = core_partition_candidates(topology);
+  core_partition partition = candidates[0];  // one thread per replica
+  if (threads_per_replica > 0) {
+    bool found = false;
+    for (const core_partition &c : candidates) {
+      if (c.threads == threads_per_replica) {
+        partition = c;
+        found = true;
+      }
+    }
+    if (!found) {
+      printf("%d threads per replica do not divide the NUMA nodes, "\
+        "using %d\n", threads_per_replica, partition.threads);
+    }
+  } else {
+    // the compile-time engine is single threaded
+    bool small = replica(0, 0, true);
+    double best = 0.0;
+    for (size_t i = 0; i < candidates.size() && !small; i++) {
+      const core_partition &c = candidates[i];
+      int replicas = min(c.groups, Replicas);
+      run(c, replicas, 0, true);
+      double start = omp_get_wtime();
+      run(c, replicas, CALIBRATION_STEPS, false);
+      double throughput = static_cast<double>(replicas) * Particles \
+        * CALIBRATION_STEPS / (omp_get_wtime() - start);
+      // rounds of the whole ensemble, the last one partly idle
+      int rounds = (Replicas + c.groups - 1) / c.groups;
+      throughput *= static_cast<double>(Replicas) / (rounds * replicas);
+      printf("Calibration %d x %d threads: %e particle-steps per second\n", \
+        c.groups, c.threads, throughput);
+      if (throughput > best) {
+        best = throughput;
+        partition = c;
+      }
+    }
+  }
+  printf("%d replicas on %d groups of %d threads (%d NUMA nodes, %d CPUs)\n",
+    Replicas, partition.groups, partition.threads,
+    static_cast<int>(topology.nodes.size()), topology.cpus);
+
+  double itime, ftime, exec_time;
+  itime = omp_get_wtime();
+
+  run(partition, Replicas, N, true);
+
+  ftime = omp_get_wtime();
+  exec_time = ftime - itime;
+  printf("Time taken is %f\n", exec_time);
+  printf("Particle-steps per second %e\n", \
+    static_cast<double>(Total) * N / exec_time);
+
+  fprintf(datacsv, "Replica,Particles,x-position,y-position,z-position, "\
+    "ex-orientation,ey-orientation,ez-orientation,time\n");
+  for (int n = 0; n < Replicas; n++) {
+    for (int k = 0; k < Particles; k++) {
+      size_t i = static_cast<size_t>(n) * Particles + k;
+      fprintf(datacsv, "%d,Particles%d,%lf,%lf,%lf,%lf,%lf,%lf,%d\n", \
+        n, k, x[i], y[i], z[i], ex[i], ey[i], ez[i], N);
+    }
+  }
+
+  free(x);
+  free(y);
+  free(z);
+  free(ex);
+  free(ey);
+  free(ez);
+
+  fclose(datacsv);
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "headers/benchmark_scenarios.h"
+#include "headers/counter_rng.h"
+
+using namespace std;
+
+const benchmark_scenario benchmark_scenarios[] = {
+  {"dilute", "dilute gas, few neighbours per cell",
+    BENCHMARK_UNIFORM, 4000, 1, 40.0, 40.0,
+    1.0, 0.0001, 1.0, 1.0, 5.0, 200},
+  {"wall_layer", "layer accumulated on the side wall",
+    BENCHMARK_WALL_LAYER, 2000, 1, 15.0, 15.0,
+    1.0, 0.0001, 1.0, 1.0, 20.0, 200},
+  {"mips", "motility-induced cluster in its gas",
+    BENCHMARK_CLUSTER, 8000, 1, 25.0, 25.0,
+    1.0, 0.0001, 1.0, 1.0, 50.0, 200},
+  {"dense", "near-jammed lattice packing",
+    BENCHMARK_LATTICE, 2000, 1, 8.0, 8.0,
+    1.0, 0.0001, 1.0, 1.0, 5.0, 200},
+  {"tall_channel", "narrow and tall cylinder, one column of cells",
+    BENCHMARK_UNIFORM, 4000, 1, 4.0, 400.0,
+    1.0, 0.0001, 1.0, 1.0, 5.0, 200},
+  {"tiny_ensemble", "1024 replicas of 16 particles",
+    BENCHMARK_UNIFORM, 16, 1024, 3.0, 3.0,
+    1.0, 0.0001, 1.0, 1.0, 5.0, 2000},
+};
+
+const int benchmark_scenario_count = \
+  sizeof(benchmark_scenarios) / sizeof(benchmark_scenarios[0]);
+
+const benchmark_scenario *benchmark_find(const char *name) {
+  for (int i = 0; i < benchmark_scenario_count; i++) {
+    if (strcmp(benchmark_scenarios[i].name, name) == 0) {
+      return &benchmark_scenarios[i];
+    }
+  }
+  return NULL;
+}
+
+// Uniform in the cylinder, 1 L away from the walls, outside the sphere of
+// radius `hole` at the centre
+static void benchmark_uniform(
+  double *x, double *y, double *z, int k, double Wall, double height,
+  double hole, uint64_t seed) {
+  for (uint64_t attempt = 0;; attempt++) {
+    x[k] = (2.0 * counter_rng_uniform(seed, attempt, k, 0) - 1.0) \
+      * (Wall - 1.0);
+    y[k] = (2.0 * counter_rng_uniform(seed, attempt, k, 1) - 1.0) \
+      * (Wall - 1.0);
+    z[k] = (2.0 * counter_rng_uniform(seed, attempt, k, 2) - 1.0) \
+      * (height - 1.0);
+    double rho_squared = x[k] * x[k] + y[k] * y[k];
+    if (rho_squared < (Wall - 1.0) * (Wall - 1.0) \
+      && rho_squared + z[k] * z[k] >= hole * hole) {
+      return;
+    }
+  }
+}
+
+// Cubic lattice points (spacing L) inside the cylinder, closest to the
+// centre first
+static vector<double> benchmark_lattice(double Wall, double height) {
+  vector<double> points;
+  int n_xy = static_cast<int>(Wall), n_z = static_cast<int>(height);
+  for (int i = -n_xy; i <= n_xy; i++) {
+    for (int j = -n_xy; j <= n_xy; j++) {
+      for (int l = -n_z; l <= n_z; l++) {
+        if (i * i + j * j < (Wall - 0.5) * (Wall - 0.5) \
+          && abs(l) < height - 0.5) {
+          points.insert(points.end(), {1.0 * i, 1.0 * j, 1.0 * l});
+        }
+      }
+    }
+  }
+  vector<int> order(points.size() / 3);
+  for (size_t p = 0; p < order.size(); p++) {
+    order[p] = p;
+  }
+  stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    double ra = points[3 * a] * points[3 * a] \
+      + points[3 * a + 1] * points[3 * a + 1] \
+      + points[3 * a + 2] * points[3 * a + 2];
+    double rb = points[3 * b] * points[3 * b] \
+      + points[3 * b + 1] * points[3 * b + 1] \
+      + points[3 * b + 2] * points[3 * b + 2];
+    return ra < rb;
+  });
+  vector<double> sorted(points.size());
+  for (size_t p = 0; p < order.size(); p++) {
+    copy(points.begin() + 3 * order[p], points.begin() + 3 * order[p] + 3, \
+      sorted.begin() + 3 * p);
+  }
+  return sorted;
+}
+
+void benchmark_initial_state(
+  const benchmark_scenario &scenario,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  uint64_t seed) {
+  int Particles = scenario.Particles;
+  double Wall = scenario.Wall, height = scenario.height;
+  int total = Particles * scenario.replicas;
+  vector<double> lattice;
+  if (scenario.layout == BENCHMARK_CLUSTER \
+    || scenario.layout == BENCHMARK_LATTICE) {
+    lattice = benchmark_lattice(Wall, height);
+  }
+  int lattice_points = lattice.size() / 3;
+  int cluster = scenario.layout == BENCHMARK_CLUSTER \
+    ? min(Particles / 2, lattice_points) : min(Particles, lattice_points);
+  double hole = 0.0;
+  if (scenario.layout == BENCHMARK_CLUSTER && cluster > 0) {
+    hole = sqrt(lattice[3 * cluster - 3] * lattice[3 * cluster - 3] \
+      + lattice[3 * cluster - 2] * lattice[3 * cluster - 2] \
+      + lattice[3 * cluster - 1] * lattice[3 * cluster - 1]) + 1.0;
+  }
+  // wall layer: rings of spacing 1.1 L along the side wall
+  double rho_layer = Wall - 0.6;
+  int ring = max(1, static_cast<int>(2.0 * M_PI * rho_layer / 1.1));
+  int rings = max(1, static_cast<int>((2.0 * height - 2.0) / 1.1));
+
+  for (int i = 0; i < total; i++) {
+    int k = i % Particles;
+    bool placed = false;
+    if (scenario.layout == BENCHMARK_WALL_LAYER) {
+      double angle = 2.0 * M_PI * (k % ring) / ring \
+        + (k / ring % 2) * M_PI / ring;
+      x[i] = rho_layer * cos(angle);
+      y[i] = rho_layer * sin(angle);
+      z[i] = 1.1 * ((k / ring) % rings) - height + 1.5;
+      placed = true;
+    } else if ((scenario.layout == BENCHMARK_CLUSTER \
+      || scenario.layout == BENCHMARK_LATTICE) && k < cluster) {
+      x[i] = lattice[3 * k];
+      y[i] = lattice[3 * k + 1];
+      z[i] = lattice[3 * k + 2];
+      placed = true;
+    }
+    if (!placed) {
+      benchmark_uniform(x, y, z, i, Wall, height, hole, seed);
+    }
+
+    // random orientation, into the wall for the wall layer
+    double e[3];
+    for (int d = 0; d < 3; d++) {
+      e[d] = counter_rng_gaussian(seed, 0, i, 10 + d);
+    }
+    if (scenario.layout == BENCHMARK_WALL_LAYER) {
+      e[0] = 0.3 * e[0] + x[i] / rho_layer;
+      e[1] = 0.3 * e[1] + y[i] / rho_layer;
+      e[2] = 0.3 * e[2];
+    }
+    double invers_norm_e = 1.0 / sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+    ex[i] = e[0] * invers_norm_e;
+    ey[i] = e[1] * invers_norm_e;
+    ez[i] = e[2] * invers_norm_e;
+  }
+}
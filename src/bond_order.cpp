@@ -0,0 +1,156 @@
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "headers/bond_order.h"
+
+using namespace std;
+
+// (l - m)! / (l + m)!, with the normalisation of the spherical harmonics
+// q_l^2 = sum_m w_lm |sum_j P_l^m(cos theta_j) e^{i m phi_j}|^2 / n^2
+static const double weight_4[5] = {
+  1.0, 1.0 / 20.0, 1.0 / 360.0, 1.0 / 5040.0, 1.0 / 40320.0};
+static const double weight_6[7] = {
+  1.0, 1.0 / 42.0, 1.0 / 1680.0, 1.0 / 60480.0, 1.0 / 1814400.0,
+  1.0 / 39916800.0, 1.0 / 479001600.0};
+
+void bond_order_open(bond_order &order, int Particles, const char *path) {
+  order.q4 = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));
+  order.q6 = reinterpret_cast<double*> \
+    (malloc(Particles * sizeof(double)));
+  order.neighbours = reinterpret_cast<int*> \
+    (malloc(Particles * sizeof(int)));
+  memset(order.histogram_q4, 0, sizeof(order.histogram_q4));
+  memset(order.histogram_q6, 0, sizeof(order.histogram_q6));
+  order.series = fopen(path, "w");
+  fprintf(order.series, "time,q4,q6,crystalline-fraction,"\
+    "crystalline-fraction-wall\n");
+}
+
+void bond_order_compute(
+  bond_order &order,
+  double *x, double *y, double *z, int Particles,
+  double r_bond, const cell_grid<3> &grid) {
+  double r_bond_squared = r_bond * r_bond;
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int k = 0; k < Particles; k++) {
+    // bond unit vectors, gathered for the simd loop below
+    double ux[BOND_ORDER_MAX_NEIGHBOURS];
+    double uy[BOND_ORDER_MAX_NEIGHBOURS];
+    double uz[BOND_ORDER_MAX_NEIGHBOURS];
+    int n = 0;
+    cell_grid_for_each_neighbour(grid, k, [&](int j) {
+      double dx = x[j] - x[k], dy = y[j] - y[k], dz = z[j] - z[k];
+      double R2 = dx * dx + dy * dy + dz * dz;
+      if (R2 < r_bond_squared && n < BOND_ORDER_MAX_NEIGHBOURS) {
+        double invers_R = 1.0 / sqrt(R2);
+        ux[n] = dx * invers_R;
+        uy[n] = dy * invers_R;
+        uz[n] = dz * invers_R;
+        n++;
+      }
+    });
+    order.neighbours[k] = n;
+    if (n == 0) {
+      order.q4[k] = 0.0;
+      order.q6[k] = 0.0;
+      continue;
+    }
+
+    // P_l^m(cos theta) e^{i m phi} = d^m P_l / dt^m (t = uz) (ux + i uy)^m,
+    // the m < 0 terms have the same modulus as m > 0
+    double re4[5] = {0.0}, im4[5] = {0.0};
+    double re6[7] = {0.0}, im6[7] = {0.0};
+#pragma omp simd reduction(+:re4[:5], im4[:5], re6[:7], im6[:7])
+    for (int i = 0; i < n; i++) {
+      double t = uz[i], t2 = t * t;
+      double cr[7], ci[7];
+      cr[0] = 1.0;
+      ci[0] = 0.0;
+      for (int m = 1; m < 7; m++) {
+        cr[m] = cr[m - 1] * ux[i] - ci[m - 1] * uy[i];
+        ci[m] = cr[m - 1] * uy[i] + ci[m - 1] * ux[i];
+      }
+      double p4[5] = {
+        (35.0 * t2 * t2 - 30.0 * t2 + 3.0) / 8.0,
+        (35.0 * t2 - 15.0) * t / 2.0,
+        (105.0 * t2 - 15.0) / 2.0,
+        105.0 * t,
+        105.0};
+      double p6[7] = {
+        (231.0 * t2 * t2 * t2 - 315.0 * t2 * t2 + 105.0 * t2 - 5.0) / 16.0,
+        (1386.0 * t2 * t2 - 1260.0 * t2 + 210.0) * t / 16.0,
+        (6930.0 * t2 * t2 - 3780.0 * t2 + 210.0) / 16.0,
+        (27720.0 * t2 - 7560.0) * t / 16.0,
+        (83160.0 * t2 - 7560.0) / 16.0,
+        10395.0 * t,
+        10395.0};
+      for (int m = 0; m < 5; m++) {
+        re4[m] += p4[m] * cr[m];
+        im4[m] += p4[m] * ci[m];
+      }
+      for (int m = 0; m < 7; m++) {
+        re6[m] += p6[m] * cr[m];
+        im6[m] += p6[m] * ci[m];
+      }
+    }
+
+    double sum4 = weight_4[0] * re4[0] * re4[0];
+    for (int m = 1; m < 5; m++) {
+      sum4 += 2.0 * weight_4[m] * (re4[m] * re4[m] + im4[m] * im4[m]);
+    }
+    double sum6 = weight_6[0] * re6[0] * re6[0];
+    for (int m = 1; m < 7; m++) {
+      sum6 += 2.0 * weight_6[m] * (re6[m] * re6[m] + im6[m] * im6[m]);
+    }
+    order.q4[k] = sqrt(sum4) / n;
+    order.q6[k] = sqrt(sum6) / n;
+  }
+}
+
+void bond_order_record(
+  bond_order &order,
+  double *x, double *y, int Particles,
+  double Wall, int L, int time) {
+  double mean_q4 = 0.0, mean_q6 = 0.0;
+  int crystalline = 0, wall = 0, crystalline_wall = 0;
+  double inner_squared = max(Wall - 2.0 * L, 0.0) * max(Wall - 2.0 * L, 0.0);
+  for (int k = 0; k < Particles; k++) {
+    mean_q4 += order.q4[k];
+    mean_q6 += order.q6[k];
+    int bin_q4 = min(static_cast<int>(order.q4[k] * BOND_ORDER_BINS), \
+      BOND_ORDER_BINS - 1);
+    int bin_q6 = min(static_cast<int>(order.q6[k] * BOND_ORDER_BINS), \
+      BOND_ORDER_BINS - 1);
+    order.histogram_q4[bin_q4] += 1;
+    order.histogram_q6[bin_q6] += 1;
+
+    bool crystal = order.q6[k] > BOND_ORDER_CRYSTAL \
+      && order.neighbours[k] >= BOND_ORDER_MIN_NEIGHBOURS;
+    crystalline += crystal;
+    if (x[k] * x[k] + y[k] * y[k] > inner_squared) {
+      wall += 1;
+      crystalline_wall += crystal;
+    }
+  }
+  fprintf(order.series, "%d,%lf,%lf,%lf,%lf\n", time, \
+    mean_q4 / Particles, mean_q6 / Particles, \
+    static_cast<double>(crystalline) / Particles, \
+    wall > 0 ? static_cast<double>(crystalline_wall) / wall : 0.0);
+}
+
+void bond_order_close(bond_order &order, const char *path) {
+  FILE *histogram = fopen(path, "w");
+  fprintf(histogram, "q,q4-count,q6-count\n");
+  for (int b = 0; b < BOND_ORDER_BINS; b++) {
+    fprintf(histogram, "%lf,%ld,%ld\n", (b + 0.5) / BOND_ORDER_BINS, \
+      order.histogram_q4[b], order.histogram_q6[b]);
+  }
+  fclose(histogram);
+  fclose(order.series);
+  free(order.q4);
+  free(order.q6);
+  free(order.neighbours);
+}
@@ -0,0 +1,249 @@
+#include <cmath>
+#include <algorithm>
+
+#include "headers/bonds.h"
+#include "headers/cell_grid.h"
+
+using namespace std;
+
+bool bond_list_setup(bond_list &bonds, FILE *file, int Particles) {
+  if (file == NULL) {
+    return false;
+  }
+  fscanf(file, "%d\t%d\t%lf\t%lf\t%lf\n", &bonds.beads_per_chain, \
+    &bonds.type, &bonds.k_bond, &bonds.r0, &bonds.k_bend);
+  int M = bonds.beads_per_chain;
+  if (M < 2 || Particles % M != 0) {
+    printf("Particles must be a multiple of the beads per chain\n");
+    bonds.beads_per_chain = 0;  // no chains, no exclusion
+    return false;
+  }
+  bonds.chains = Particles / M;
+
+  // chain after chain, in bead order
+  bonds.chain_bonds.assign(1, 0);
+  bonds.chain_angles.assign(1, 0);
+  for (int c = 0; c < bonds.chains; c++) {
+    int first = c * M;
+    for (int b = 0; b < M - 1; b++) {
+      bonds.bond_i.push_back(first + b);
+      bonds.bond_j.push_back(first + b + 1);
+    }
+    for (int b = 0; b < M - 2; b++) {
+      bonds.angle_i.push_back(first + b);
+      bonds.angle_j.push_back(first + b + 1);
+      bonds.angle_k.push_back(first + b + 2);
+    }
+    bonds.chain_bonds.push_back(bonds.bond_i.size());
+    bonds.chain_angles.push_back(bonds.angle_i.size());
+  }
+  printf("%d chains of %d beads\n", bonds.chains, M);
+  return true;
+}
+
+// Squared distance from (px, py, pz) to the closest bead of `occupants`,
+// in the cells around it, but `skip`
+static double bond_list_closest(
+  const cell_grid<3> &grid, const vector<vector<int>> &occupants,
+  const double *x, const double *y, const double *z,
+  double px, double py, double pz, int skip) {
+  double position[3] = {px, py, pz};
+  int c[3];
+  for (int d = 0; d < 3; d++) {
+    c[d] = cell_grid_coordinate(grid, position[d], d);
+  }
+  double closest = INFINITY;
+  for (int c2 = max(c[2] - 1, 0); c2 <= min(c[2] + 1, grid.n[2] - 1); c2++) {
+    for (int c1 = max(c[1] - 1, 0); c1 <= min(c[1] + 1, grid.n[1] - 1); \
+      c1++) {
+      for (int c0 = max(c[0] - 1, 0); c0 <= min(c[0] + 1, grid.n[0] - 1); \
+        c0++) {
+        for (int o : occupants[c0 + grid.n[0] * (c1 + grid.n[1] * c2)]) {
+          double R2 = (x[o] - px) * (x[o] - px) + (y[o] - py) * (y[o] - py) \
+            + (z[o] - pz) * (z[o] - pz);
+          if (o != skip) {
+            closest = min(closest, R2);
+          }
+        }
+      }
+    }
+  }
+  return closest;
+}
+
+void bond_list_place(
+  const bond_list &bonds, double *x, double *y, double *z,
+  double Wall, double height, double L,
+  default_random_engine &generator) {
+  normal_distribution<double> Gaussdistribution(0.0, 1.0);
+  uniform_real_distribution<double> distribution(-1.0, 1.0);
+  // close to the minimum of the bond potential (FENE + WCA: 0.97 L)
+  double length = bonds.type == BOND_FENE ? 0.97 * L : bonds.r0;
+  // the separation of the Poisson-disk samples, but along the bonds
+  double separation_squared = 1.5 * L * 1.5 * L;
+  cell_grid<3> grid;
+  double lower[3] = {-Wall, -Wall, -height}, upper[3] = {Wall, Wall, height};
+  cell_grid_setup(grid, lower, upper, 1.5 * L);
+  vector<vector<int>> occupants(grid.cell_start.size() - 1);
+  auto cell_of = [&](int i) {
+    return cell_grid_coordinate(grid, x[i], 0) + grid.n[0] \
+      * (cell_grid_coordinate(grid, y[i], 1) + grid.n[1] \
+      * cell_grid_coordinate(grid, z[i], 2));
+  };
+  // first beads moved inside the cylinder
+  for (int c = 0; c < bonds.chains; c++) {
+    int i = c * bonds.beads_per_chain;
+    double rho = sqrt(x[i] * x[i] + y[i] * y[i]);
+    if (rho > Wall - 1.0) {
+      x[i] *= (Wall - 1.0) / rho;
+      y[i] *= (Wall - 1.0) / rho;
+    }
+    z[i] = min(max(z[i], 1.0 - height), height - 1.0);
+    occupants[cell_of(i)].push_back(i);
+  }
+  int crowded = 0;
+  for (int c = 0; c < bonds.chains; c++) {
+    // a chain stuck among the beads already placed grows again from its
+    // first bead, moved to a free place after half the growths; the last
+    // growth is kept
+    int first = c * bonds.beads_per_chain;
+    for (int growth = 0; growth < BOND_PLACE_GROWTHS; growth++) {
+      if (growth >= BOND_PLACE_GROWTHS / 2) {
+        vector<int> &cell = occupants[cell_of(first)];
+        cell.erase(find(cell.begin(), cell.end(), first));
+        for (int count = 0; count < BOND_PLACE_DRAWS; count++) {
+          x[first] = (Wall - 1.0) * distribution(generator);
+          y[first] = (Wall - 1.0) * distribution(generator);
+          z[first] = (height - 1.0) * distribution(generator);
+          if (x[first] * x[first] + y[first] * y[first] \
+            < (Wall - 1.0) * (Wall - 1.0) \
+            && bond_list_closest(grid, occupants, x, y, z, x[first], \
+              y[first], z[first], -1) >= separation_squared) {
+            break;
+          }
+        }
+        occupants[cell_of(first)].push_back(first);
+      }
+      // the first beads moved inside the cylinder may be closer
+      int crowded_chain = bond_list_closest(
+        grid, occupants, x, y, z, x[first], y[first], z[first], first) \
+        < separation_squared;
+      for (int b = bonds.chain_bonds[c]; b < bonds.chain_bonds[c + 1]; b++) {
+        int i = bonds.bond_i[b], j = bonds.bond_j[b];
+        // new direction while the bead is outside the cylinder, the walls
+        // would stretch the bond otherwise, or closer than the separation
+        // to a bead already placed; the farthest of BOND_PLACE_DRAWS draws
+        double best[3] = {x[i], y[i], z[i]}, best_closest = -1.0;
+        for (int count = 0; count < BOND_PLACE_DRAWS; count++) {
+          double u[3] = {Gaussdistribution(generator),
+            Gaussdistribution(generator), Gaussdistribution(generator)};
+          double scale = length \
+            / sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+          double p[3] = {x[i] + scale * u[0], y[i] + scale * u[1],
+            z[i] + scale * u[2]};
+          if (p[0] * p[0] + p[1] * p[1] >= (Wall - 1.0) * (Wall - 1.0) \
+            || abs(p[2]) >= height - 1.0) {
+            if (best_closest < 0.0) {
+              copy(p, p + 3, best);  // the last draw when all are outside
+            }
+            continue;
+          }
+          double closest = bond_list_closest(
+            grid, occupants, x, y, z, p[0], p[1], p[2], i);
+          if (closest > best_closest) {
+            copy(p, p + 3, best);
+            best_closest = closest;
+          }
+          if (closest >= separation_squared) {
+            break;
+          }
+        }
+        x[j] = best[0];
+        y[j] = best[1];
+        z[j] = best[2];
+        crowded_chain += best_closest < separation_squared;
+        occupants[cell_of(j)].push_back(j);
+      }
+      if (crowded_chain == 0 || growth == BOND_PLACE_GROWTHS - 1) {
+        crowded += crowded_chain;
+        break;
+      }
+      for (int b = bonds.chain_bonds[c]; b < bonds.chain_bonds[c + 1]; b++) {
+        vector<int> &cell = occupants[cell_of(bonds.bond_j[b])];
+        cell.erase(find(cell.begin(), cell.end(), bonds.bond_j[b]));
+      }
+    }
+  }
+  if (crowded > 0) {
+    printf("Beads closer than 1.5 L to another particle: %d\n", crowded);
+  }
+}
+
+void bond_list_apply(
+  const bond_list &bonds, double *x, double *y, double *z, double delta,
+  double epsilon, double L) {
+  int M = bonds.beads_per_chain;
+  double wca_cutoff = pow(2.0, 1.0 / 6.0) * L;
+  double f_max = 0.1 / delta;  // at most 0.1 L displacement per step
+#pragma omp parallel
+  {
+    vector<double> F(3 * M);  // forces on the beads of the current chain
+#pragma omp for schedule(static)
+    for (int c = 0; c < bonds.chains; c++) {
+      int first = c * M;
+      fill(F.begin(), F.end(), 0.0);
+
+      for (int b = bonds.chain_bonds[c]; b < bonds.chain_bonds[c + 1]; b++) {
+        int i = bonds.bond_i[b], j = bonds.bond_j[b];
+        double d[3] = {x[j] - x[i], y[j] - y[i], z[j] - z[i]};
+        double n = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        double f;  // along d, on j
+        if (bonds.type == BOND_FENE) {
+          double ratio = min(n / bonds.r0, 0.99);
+          f = -bonds.k_bond * n / (1.0 - ratio * ratio);
+          // WCA of the bonded pair (Kremer-Grest), excluded elsewhere
+          if (n < wca_cutoff) {
+            double s6 = pow(L / n, 6);
+            f += 24.0 * epsilon * (2.0 * s6 * s6 - s6) / n;
+          }
+        } else {
+          f = -bonds.k_bond * (n - bonds.r0);
+        }
+        for (int a = 0; a < 3; a++) {
+          F[3 * (j - first) + a] += f * d[a] / n;
+          F[3 * (i - first) + a] -= f * d[a] / n;
+        }
+      }
+
+      // k_bend (1 - cos phi), phi between consecutive bonds
+      for (int a = bonds.chain_angles[c]; a < bonds.chain_angles[c + 1]; a++) {
+        int i = bonds.angle_i[a], j = bonds.angle_j[a], k = bonds.angle_k[a];
+        double b1[3] = {x[j] - x[i], y[j] - y[i], z[j] - z[i]};
+        double b2[3] = {x[k] - x[j], y[k] - y[j], z[k] - z[j]};
+        double n1 = sqrt(b1[0] * b1[0] + b1[1] * b1[1] + b1[2] * b1[2]);
+        double n2 = sqrt(b2[0] * b2[0] + b2[1] * b2[1] + b2[2] * b2[2]);
+        double cosine = (b1[0] * b2[0] + b1[1] * b2[1] + b1[2] * b2[2]) \
+          / (n1 * n2);
+        for (int d = 0; d < 3; d++) {
+          double dc_db1 = b2[d] / (n1 * n2) - cosine * b1[d] / (n1 * n1);
+          double dc_db2 = b1[d] / (n1 * n2) - cosine * b2[d] / (n2 * n2);
+          double Fi = -bonds.k_bend * dc_db1;
+          double Fk = bonds.k_bend * dc_db2;
+          F[3 * (i - first) + d] += Fi;
+          F[3 * (k - first) + d] += Fk;
+          F[3 * (j - first) + d] -= Fi + Fk;
+        }
+      }
+
+      // stretched bonds (walls, FENE close to r0) relax over a few steps
+      for (int b = 0; b < M; b++) {
+        double norm = sqrt(F[3 * b] * F[3 * b] + F[3 * b + 1] * F[3 * b + 1] \
+          + F[3 * b + 2] * F[3 * b + 2]);
+        double scale = norm > f_max ? f_max / norm : 1.0;
+        x[first + b] += scale * F[3 * b] * delta;
+        y[first + b] += scale * F[3 * b + 1] * delta;
+        z[first + b] += scale * F[3 * b + 2] * delta;
+      }
+    }
+  }
+}
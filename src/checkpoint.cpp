@@ -0,0 +1,143 @@
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cstring>
+#include <string>
+
+#include "headers/checkpoint.h"
+
+#define CHECKPOINT_MAGIC "ABPCKPT3"
+
+using namespace std;
+
+bool checkpoint_write(
+  const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time, uint64_t seed,
+  const double *field, size_t field_values) {
+  string temporary = string(path) + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "wb");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = fwrite(CHECKPOINT_MAGIC, 1, 8, file) == 8;
+  ok = ok && fwrite(&Particles, sizeof(int), 1, file) == 1;
+  ok = ok && fwrite(&time, sizeof(int), 1, file) == 1;
+  ok = ok && fwrite(&seed, sizeof(uint64_t), 1, file) == 1;
+  double *arrays[6] = {x, y, z, ex, ey, ez};
+  for (int i = 0; i < 6; i++) {
+    ok = ok && fwrite(arrays[i], sizeof(double), Particles, file) \
+      == static_cast<size_t>(Particles);
+  }
+  uint64_t values = field_values;
+  ok = ok && fwrite(&values, sizeof(uint64_t), 1, file) == 1;
+  ok = ok && fwrite(field, sizeof(double), field_values, file) \
+    == field_values;
+  ok = (fclose(file) == 0) && ok;
+  if (!ok) {
+    remove(temporary.c_str());
+    return false;
+  }
+  return rename(temporary.c_str(), path) == 0;
+}
+
+bool checkpoint_read(
+  const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int &time, uint64_t &seed,
+  double *field, size_t field_values) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  char magic[8];
+  int particles_file = 0;
+  bool ok = fread(magic, 1, 8, file) == 8 \
+    && memcmp(magic, CHECKPOINT_MAGIC, 8) == 0;
+  ok = ok && fread(&particles_file, sizeof(int), 1, file) == 1 \
+    && particles_file == Particles;
+  ok = ok && fread(&time, sizeof(int), 1, file) == 1;
+  ok = ok && fread(&seed, sizeof(uint64_t), 1, file) == 1;
+  double *arrays[6] = {x, y, z, ex, ey, ez};
+  for (int i = 0; i < 6; i++) {
+    ok = ok && fread(arrays[i], sizeof(double), Particles, file) \
+      == static_cast<size_t>(Particles);
+  }
+  uint64_t values = 0;
+  ok = ok && fread(&values, sizeof(uint64_t), 1, file) == 1 \
+    && values == field_values;
+  ok = ok && fread(field, sizeof(double), field_values, file) \
+    == field_values;
+  fclose(file);
+  return ok;
+}
+
+bool checkpoint_time(const char *path, int &time) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  char magic[8];
+  int particles_file = 0;
+  bool ok = fread(magic, 1, 8, file) == 8 \
+    && memcmp(magic, CHECKPOINT_MAGIC, 8) == 0;
+  ok = ok && fread(&particles_file, sizeof(int), 1, file) == 1;
+  ok = ok && fread(&time, sizeof(int), 1, file) == 1;
+  fclose(file);
+  return ok;
+}
+
+void checkpoint_reap(checkpoint_children &children, bool wait_all) {
+  for (size_t i = 0; i < children.running.size();) {
+    int status = 0;
+    pid_t pid = waitpid(children.running[i], &status, wait_all ? 0 : WNOHANG);
+    if (pid == 0) {
+      i++;  // still writing
+      continue;
+    }
+    if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      children.completed += 1;
+    } else {
+      children.failed += 1;
+    }
+    children.running.erase(children.running.begin() + i);
+  }
+}
+
+void checkpoint_fork(
+  checkpoint_children &children, const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time, uint64_t seed,
+  const double *field, size_t field_values) {
+  checkpoint_reap(children, false);
+  while (static_cast<int>(children.running.size()) >= children.max_children) {
+    // oldest child first, it is the most likely to be done
+    int status = 0;
+    pid_t pid = waitpid(children.running.front(), &status, 0);
+    if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      children.completed += 1;
+    } else {
+      children.failed += 1;
+    }
+    children.running.erase(children.running.begin());
+  }
+
+  fflush(stdout);  // the child must not print the parent's buffered output
+  pid_t pid = fork();
+  if (pid == 0) {
+    // child: single threaded copy of the memory at the time of the fork
+    bool ok = checkpoint_write(
+      path, x, y, z, ex, ey, ez, Particles, time, seed,
+      field, field_values);
+    _exit(ok ? 0 : 1);
+  } else if (pid > 0) {
+    children.running.push_back(pid);
+  } else {
+    if (checkpoint_write(
+      path, x, y, z, ex, ey, ez, Particles, time, seed,
+      field, field_values)) {
+      children.completed += 1;
+    } else {
+      children.failed += 1;
+    }
+  }
+}
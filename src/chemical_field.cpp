@@ -0,0 +1,194 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "headers/chemical_field.h"
+
+using namespace std;
+
+// Linear index of node (i, j, k), -1 and n are the ghost layers
+static inline size_t chemical_index(
+  const chemical_field &field, int i, int j, int k) {
+  return (static_cast<size_t>(k + 1) * (field.n[1] + 2) + (j + 1)) \
+    * (field.n[0] + 2) + (i + 1);
+}
+
+// Node below the position along d and the fractional part
+static inline void chemical_locate(
+  const chemical_field &field, double position, int d, int &i, double &f) {
+  double u = (position - field.lower[d]) / field.h;
+  u = min(max(u, 0.0), field.n[d] - 1.000001);
+  i = static_cast<int>(u);
+  f = u - i;
+}
+
+bool chemical_field_setup(
+  chemical_field &field, FILE *file,
+  double Wall, double height, double delta) {
+  if (file == NULL) {
+    return false;
+  }
+  fscanf(file, "%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\n", \
+    &field.D, &field.decay, &field.production, \
+    &field.chi, &field.mu, &field.h, &field.substeps);
+
+  double extent[3] = {2.0 * Wall, 2.0 * Wall, 2.0 * height};
+  size_t size = 1;
+  for (int d = 0; d < 3; d++) {
+    field.n[d] = static_cast<int>(ceil(extent[d] / field.h)) + 1;
+    field.lower[d] = -0.5 * extent[d];
+    size *= field.n[d] + 2;
+  }
+  // explicit scheme positive (and stable) for 6 D dt / h^2 + decay dt < 1,
+  // strict so that the checkerboard mode decays too
+  int stable = static_cast<int>(floor(6.0 * field.D * delta \
+    / (field.h * field.h) + field.decay * delta)) + 1;
+  field.substeps = max(max(field.substeps, stable), 1);
+
+  size_t bytes = (size * sizeof(double) + 63) / 64 * 64;
+  field.c = reinterpret_cast<double*>(aligned_alloc(64, bytes));
+  field.c_next = reinterpret_cast<double*>(aligned_alloc(64, bytes));
+  memset(field.c, 0, bytes);
+  memset(field.c_next, 0, bytes);
+  printf("Chemical field %d x %d x %d, %d sub-steps\n", \
+    field.n[0], field.n[1], field.n[2], field.substeps);
+  return true;
+}
+
+// No flux through the faces of the grid: ghost = adjacent node
+static void chemical_ghosts(chemical_field &field) {
+  int nx = field.n[0], ny = field.n[1], nz = field.n[2];
+  double *c = field.c;
+#pragma omp parallel for
+  for (int k = 0; k < nz; k++) {
+    for (int j = 0; j < ny; j++) {
+      c[chemical_index(field, -1, j, k)] = c[chemical_index(field, 0, j, k)];
+      c[chemical_index(field, nx, j, k)] = \
+        c[chemical_index(field, nx - 1, j, k)];
+    }
+    for (int i = 0; i < nx; i++) {
+      c[chemical_index(field, i, -1, k)] = c[chemical_index(field, i, 0, k)];
+      c[chemical_index(field, i, ny, k)] = \
+        c[chemical_index(field, i, ny - 1, k)];
+    }
+  }
+#pragma omp parallel for
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      c[chemical_index(field, i, j, -1)] = c[chemical_index(field, i, j, 0)];
+      c[chemical_index(field, i, j, nz)] = \
+        c[chemical_index(field, i, j, nz - 1)];
+    }
+  }
+}
+
+void chemical_field_update(
+  chemical_field &field,
+  double *x, double *y, double *z, int Particles, double delta) {
+  // Deposition, trilinear weights
+  double amount = field.production * delta / (field.h * field.h * field.h);
+#pragma omp parallel for
+  for (int k = 0; k < Particles; k++) {
+    int i0, j0, k0;
+    double fx, fy, fz;
+    chemical_locate(field, x[k], 0, i0, fx);
+    chemical_locate(field, y[k], 1, j0, fy);
+    chemical_locate(field, z[k], 2, k0, fz);
+    for (int c = 0; c < 8; c++) {
+      int di = c & 1, dj = (c >> 1) & 1, dk = (c >> 2) & 1;
+      double w = (di ? fx : 1.0 - fx) * (dj ? fy : 1.0 - fy) \
+        * (dk ? fz : 1.0 - fz);
+#pragma omp atomic
+      field.c[chemical_index(field, i0 + di, j0 + dj, k0 + dk)] += amount * w;
+    }
+  }
+
+  // Diffusion and decay, 7-point stencil, sub-cycled
+  int nx = field.n[0], ny = field.n[1], nz = field.n[2];
+  size_t sx = nx + 2, sxy = sx * (ny + 2);
+  double dt = delta / field.substeps;
+  double a = field.D * dt / (field.h * field.h);
+  double b = 1.0 - 6.0 * a - field.decay * dt;
+  for (int s = 0; s < field.substeps; s++) {
+    chemical_ghosts(field);
+    const double *c = field.c;
+    double *c_next = field.c_next;
+#pragma omp parallel for collapse(2) schedule(static)
+    for (int kb = 0; kb < nz; kb += CHEMICAL_BLOCK_Z) {
+      for (int jb = 0; jb < ny; jb += CHEMICAL_BLOCK_Y) {
+        int k_end = min(kb + CHEMICAL_BLOCK_Z, nz);
+        int j_end = min(jb + CHEMICAL_BLOCK_Y, ny);
+        for (int k = kb; k < k_end; k++) {
+          for (int j = jb; j < j_end; j++) {
+            size_t row = chemical_index(field, 0, j, k);
+            const double *in = c + row;
+            double *out = c_next + row;
+#pragma omp simd
+            for (int i = 0; i < nx; i++) {
+              out[i] = b * in[i] + a * (in[i - 1] + in[i + 1] \
+                + in[i - sx] + in[i + sx] + in[i - sxy] + in[i + sxy]);
+            }
+          }
+        }
+      }
+    }
+    swap(field.c, field.c_next);
+  }
+  chemical_ghosts(field);  // for the gradients of chemical_field_couple
+}
+
+void chemical_field_couple(
+  const chemical_field &field,
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, int Particles, double delta) {
+  size_t stride[3] = {1, static_cast<size_t>(field.n[0] + 2), \
+    static_cast<size_t>(field.n[0] + 2) * (field.n[1] + 2)};
+  double invers_2h = 0.5 / field.h;
+  const double *c = field.c;
+#pragma omp parallel for
+  for (int k = 0; k < Particles; k++) {
+    int i0, j0, k0;
+    double fx, fy, fz;
+    chemical_locate(field, x[k], 0, i0, fx);
+    chemical_locate(field, y[k], 1, j0, fy);
+    chemical_locate(field, z[k], 2, k0, fz);
+
+    // central differences at the 8 nodes around, trilinear interpolation
+    double g[3] = {0.0, 0.0, 0.0};
+    for (int n = 0; n < 8; n++) {
+      int di = n & 1, dj = (n >> 1) & 1, dk = (n >> 2) & 1;
+      double w = (di ? fx : 1.0 - fx) * (dj ? fy : 1.0 - fy) \
+        * (dk ? fz : 1.0 - fz);
+      size_t node = chemical_index(field, i0 + di, j0 + dj, k0 + dk);
+      for (int d = 0; d < 3; d++) {
+        g[d] += w * (c[node + stride[d]] - c[node - stride[d]]) * invers_2h;
+      }
+    }
+
+    // e turns towards the gradient, de = chi (g - (e.g) e) dt
+    double e_dot_g = ex[k] * g[0] + ey[k] * g[1] + ez[k] * g[2];
+    ex[k] += field.chi * (g[0] - e_dot_g * ex[k]) * delta;
+    ey[k] += field.chi * (g[1] - e_dot_g * ey[k]) * delta;
+    ez[k] += field.chi * (g[2] - e_dot_g * ez[k]) * delta;
+    double invers_norm_e = 1.0 / sqrt(ex[k] * ex[k] + ey[k] * ey[k] \
+      + ez[k] * ez[k]);
+    ex[k] *= invers_norm_e;
+    ey[k] *= invers_norm_e;
+    ez[k] *= invers_norm_e;
+
+    x[k] += field.mu * g[0] * delta;
+    y[k] += field.mu * g[1] * delta;
+    z[k] += field.mu * g[2] * delta;
+  }
+}
+
+size_t chemical_field_values(const chemical_field &field) {
+  return static_cast<size_t>(field.n[0] + 2) * (field.n[1] + 2) \
+    * (field.n[2] + 2);
+}
+
+void chemical_field_free(chemical_field &field) {
+  free(field.c);
+  free(field.c_next);
+}
@@ -0,0 +1,18 @@
+#include "headers/circular_reflective_boundary_conditions.h"
+
+using namespace std;
+
+void circular_reflective_boundary_conditions(
+  double *x, double *y, int Particles,
+  double Wall) {
+    double Wall_squared = Wall * Wall;
+#pragma omp parallel for simd
+    for (int k = 0; k < Particles; k++) {
+      double distance_squared = x[k] * x[k] + y[k] * y[k];
+      if (distance_squared > Wall_squared) {
+        double scale = Wall / sqrt(distance_squared);
+        x[k] = scale * x[k];
+        y[k] = scale * y[k];
+      }
+    }
+}
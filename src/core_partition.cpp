@@ -0,0 +1,141 @@
+#include <sched.h>
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+
+#include "headers/core_partition.h"
+
+using namespace std;
+
+// "0-3,8-11" -> 0 1 2 3 8 9 10 11
+static vector<int> numa_parse_cpulist(const char *list) {
+  vector<int> cpus;
+  const char *p = list;
+  while (*p != '\0' && *p != '\n') {
+    int first, last, read = 0;
+    if (sscanf(p, "%d-%d%n", &first, &last, &read) != 2) {
+      read = 0;
+      if (sscanf(p, "%d%n", &first, &read) != 1) {
+        break;
+      }
+      last = first;
+    }
+    for (int cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+    p += read;
+    if (*p == ',') {
+      p++;
+    }
+  }
+  return cpus;
+}
+
+void numa_topology_read(numa_topology &topology) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+
+  topology.nodes.clear();
+  char path[64], list[4096];
+  for (int node = 0; node < 1024; node++) {
+    snprintf(path, sizeof(path), \
+      "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+      if (node == 0) {
+        break;
+      }
+      continue;  // nodes can be numbered with gaps
+    }
+    vector<int> cpus;
+    if (fgets(list, sizeof(list), file) != NULL) {
+      for (int cpu : numa_parse_cpulist(list)) {
+        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+          cpus.push_back(cpu);
+        }
+      }
+    }
+    fclose(file);
+    if (!cpus.empty()) {
+      topology.nodes.push_back(cpus);
+    }
+  }
+  if (topology.nodes.empty()) {
+    vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        cpus.push_back(cpu);
+      }
+    }
+    topology.nodes.push_back(cpus);
+  }
+  topology.cpus = 0;
+  for (const vector<int> &node : topology.nodes) {
+    topology.cpus += node.size();
+  }
+}
+
+vector<core_partition> core_partition_candidates(
+  const numa_topology &topology) {
+  int smallest = topology.cpus;
+  for (const vector<int> &node : topology.nodes) {
+    smallest = min(smallest, static_cast<int>(node.size()));
+  }
+  vector<int> sizes;
+  for (int t = 1; t <= smallest; t *= 2) {
+    sizes.push_back(t);
+  }
+  sizes.push_back(smallest);
+#ifdef ABP_WORK_STEALING
+  sizes.assign(1, 1);
+#endif
+
+  vector<core_partition> candidates;
+  for (int t : sizes) {
+    bool even = true;
+    for (const vector<int> &node : topology.nodes) {
+      even = even && node.size() % t == 0;
+    }
+    bool seen = false;
+    for (const core_partition &c : candidates) {
+      seen = seen || c.threads == t;
+    }
+    if (!even || seen) {
+      continue;
+    }
+    core_partition partition;
+    partition.threads = t;
+    for (const vector<int> &node : topology.nodes) {
+      for (size_t first = 0; first < node.size(); first += t) {
+        partition.group_cpus.push_back(
+          vector<int>(node.begin() + first, node.begin() + first + t));
+      }
+    }
+    partition.groups = partition.group_cpus.size();
+    candidates.push_back(partition);
+  }
+#ifndef ABP_WORK_STEALING
+  if (topology.nodes.size() > 1) {
+    core_partition all;
+    all.groups = 1;
+    all.threads = topology.cpus;
+    all.group_cpus.resize(1);
+    for (const vector<int> &node : topology.nodes) {
+      all.group_cpus[0].insert(all.group_cpus[0].end(), \
+        node.begin(), node.end());
+    }
+    candidates.push_back(all);
+  }
+#endif
+  return candidates;
+}
+
+void core_partition_pin(const core_partition &partition, int g) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : partition.group_cpus[g]) {
+    CPU_SET(cpu, &set);
+  }
+  sched_setaffinity(0, sizeof(set), &set);
+}
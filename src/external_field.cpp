@@ -0,0 +1,28 @@
+#include "headers/external_field.h"
+
+using namespace std;
+
+bool external_field_setup(external_field &field, FILE *file) {
+  if (file == NULL) {
+    return false;
+  }
+  fscanf(file, "%lf\t%lf\t%lf\t%lf\t%lf\t%lf\n", \
+    &field.sedimentation, &field.trap, \
+    &field.centre[0], &field.centre[1], &field.centre[2], \
+    &field.gravitaxis);
+  printf("External field %lf\t%lf\t(%lf, %lf, %lf)\t%lf\n", \
+    field.sedimentation, field.trap, \
+    field.centre[0], field.centre[1], field.centre[2], field.gravitaxis);
+  return true;
+}
+
+bool external_field_setup_flow(
+  external_field &field, FILE *file, double Wall) {
+  if (file == NULL) {
+    return false;
+  }
+  fscanf(file, "%lf\n", &field.flow);
+  field.radius = Wall;
+  printf("Poiseuille flow %lf\n", field.flow);
+  return true;
+}
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+#include "headers/flight_recorder.h"
+#include "headers/print_file.h"
+
+using namespace std;
+
+void flight_recorder_open(
+  flight_recorder &recorder, int frames, int Particles, int cluster,
+  double Wall, double height, double cutoff) {
+  recorder.frames = frames;
+  recorder.Particles = Particles;
+  recorder.data = reinterpret_cast<double*> \
+    (malloc(static_cast<size_t>(frames) * 6 * Particles * sizeof(double)));
+  recorder.time.assign(frames, 0);
+  recorder.recorded = 0;
+  recorder.dumped = -frames;
+  recorder.cluster = cluster;
+  recorder.Wall = Wall;
+  recorder.height = height;
+  double lower[3] = {-Wall, -Wall, -height}, upper[3] = {Wall, Wall, height};
+  cell_grid_setup(recorder.grid, lower, upper, cutoff);
+  recorder.occupancy.resize(recorder.grid.cell_start.size() - 1);
+  recorder.clustered = false;
+  recorder.escaped = false;
+  recorder.dumps = 0;
+  printf("Flight recorder of %d frames (%f MB)\n", frames, \
+    static_cast<double>(frames) * 6 * Particles * sizeof(double) / 1.0e6);
+}
+
+static double *flight_recorder_slot(const flight_recorder &recorder, long n) {
+  return recorder.data \
+    + static_cast<size_t>(n % recorder.frames) * 6 * recorder.Particles;
+}
+
+// Frames of the buffer, oldest first
+static void flight_recorder_dump(
+  flight_recorder &recorder, const char *event, int time) {
+  char path[64];
+  snprintf(path, sizeof(path), "./data/flight_%d_%s.csv", time, event);
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    printf("cannot write %s\n", path);
+    return;
+  }
+  fprintf(file, "Particles,x-position,y-position,z-position, "\
+    "ex-orientation,ey-orientation,ez-orientation,time\n");
+  int Particles = recorder.Particles;
+  long first = max(recorder.recorded - recorder.frames, recorder.dumped);
+  first = max(first, 0L);
+  for (long n = first; n < recorder.recorded; n++) {
+    double *frame = flight_recorder_slot(recorder, n);
+    print_file(
+      frame, frame + Particles, frame + 2 * Particles,
+      frame + 3 * Particles, frame + 4 * Particles, frame + 5 * Particles,
+      Particles, recorder.time[n % recorder.frames], file);
+  }
+  fclose(file);
+  recorder.dumped = recorder.recorded;
+  recorder.dumps++;
+  printf("Flight recorder: %s at step %d, %ld frames in %s\n", event, time, \
+    recorder.recorded - first, path);
+}
+
+bool flight_recorder_step(
+  flight_recorder &recorder,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int time) {
+  int Particles = recorder.Particles;
+  double *frame = flight_recorder_slot(recorder, recorder.recorded);
+  double *source[6] = {x, y, z, ex, ey, ez};
+  for (int c = 0; c < 6; c++) {
+    memcpy(frame + static_cast<size_t>(c) * Particles, source[c], \
+      Particles * sizeof(double));
+  }
+  recorder.time[recorder.recorded % recorder.frames] = time;
+  recorder.recorded++;
+
+  int not_finite = 0, outside = 0;
+  double Wall_squared = recorder.Wall * recorder.Wall;
+#pragma omp parallel for reduction(+:not_finite, outside)
+  for (int k = 0; k < Particles; k++) {
+    not_finite += !isfinite(x[k] + y[k] + z[k] + ex[k] + ey[k] + ez[k]);
+    outside += x[k] * x[k] + y[k] * y[k] > Wall_squared \
+      || fabs(z[k]) > recorder.height;
+  }
+  // the events of one step go in one dump, named after all of them
+  string events;
+  if (not_finite > 0) {
+    events = "nan";
+  }
+
+  bool escaped = outside > 0;
+  if (escaped && !recorder.escaped) {
+    events += events.empty() ? "escape" : "-escape";
+  }
+  recorder.escaped = escaped;
+
+  if (recorder.cluster > 0 && not_finite == 0) {
+    // densest cell, particles counted in the cell of their position
+    int *occupancy = recorder.occupancy.data();
+    int cells = static_cast<int>(recorder.occupancy.size());
+#pragma omp parallel for simd
+    for (int c = 0; c < cells; c++) {
+      occupancy[c] = 0;
+    }
+    int densest = 0;
+#pragma omp parallel for reduction(max:densest)
+    for (int k = 0; k < Particles; k++) {
+      double position[3] = {x[k], y[k], z[k]};
+      int cell = 0;
+      for (int d = 2; d >= 0; d--) {
+        cell = cell * recorder.grid.n[d] \
+          + cell_grid_coordinate(recorder.grid, position[d], d);
+      }
+      int count;
+#pragma omp atomic capture
+      count = ++occupancy[cell];
+      densest = max(densest, count);
+    }
+    bool clustered = densest >= recorder.cluster;
+    if (clustered && !recorder.clustered) {
+      events += events.empty() ? "cluster" : "-cluster";
+    }
+    recorder.clustered = clustered;
+  }
+
+  if (!events.empty()) {
+    flight_recorder_dump(recorder, events.c_str(), time);
+  }
+  return not_finite == 0;
+}
+
+void flight_recorder_close(flight_recorder &recorder) {
+  printf("\nFlight recorder: %d dumps", recorder.dumps);
+  free(recorder.data);
+}
@@ -0,0 +1,39 @@
+#ifndef SRC_HEADERS_BENCHMARK_SCENARIOS_H_
+#define SRC_HEADERS_BENCHMARK_SCENARIOS_H_
+
+#include <stdint.h>
+
+// How the initial state of a scenario is generated
+#define BENCHMARK_UNIFORM 0     // uniform in the cylinder
+#define BENCHMARK_WALL_LAYER 1  // one layer on the side wall, swimming into it
+#define BENCHMARK_CLUSTER 2     // dense spherical cluster and its gas
+#define BENCHMARK_LATTICE 3     // cubic lattice filling the cylinder
+
+// Named, deterministic workload: parameters (as in parameter.txt), initial
+// state and number of steps. `replicas` > 1 runs independent copies of
+// `Particles` particles, as abp_3D_ensemble does.
+struct benchmark_scenario {
+  const char *name;
+  const char *description;
+  int layout;
+  int Particles;
+  int replicas;
+  double Wall, height;
+  double epsilon, delta, Dt, De, vs;
+  int steps;
+};
+
+extern const benchmark_scenario benchmark_scenarios[];
+extern const int benchmark_scenario_count;
+
+// NULL for an unknown name
+const benchmark_scenario *benchmark_find(const char *name);
+
+// Initial state of every replica (arrays of Particles * replicas), a
+// function of the scenario and `seed` only.
+void benchmark_initial_state(
+  const benchmark_scenario &scenario,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  uint64_t seed);
+
+#endif  // SRC_HEADERS_BENCHMARK_SCENARIOS_H_
@@ -0,0 +1,42 @@
+#ifndef SRC_HEADERS_BOND_ORDER_H_
+#define SRC_HEADERS_BOND_ORDER_H_
+
+#include <stdio.h>
+
+#include "cell_grid.h"
+
+#define BOND_ORDER_BINS 50  // histogram bins over [0, 1]
+#define BOND_ORDER_MAX_NEIGHBOURS 32
+#define BOND_ORDER_CRYSTAL 0.5  // q6 above which a particle is crystalline
+#define BOND_ORDER_MIN_NEIGHBOURS 6  // and has at least this many neighbours
+
+// In-situ Steinhardt q4/q6, histograms accumulated over the run and
+// crystalline fraction time series (all particles and those at less than
+// 2 L from the side wall).
+struct bond_order {
+  double *q4, *q6;  // per particle, last computed values
+  int *neighbours;  // number of neighbours used for q4, q6
+  long histogram_q4[BOND_ORDER_BINS];
+  long histogram_q6[BOND_ORDER_BINS];
+  FILE *series;
+};
+
+void bond_order_open(bond_order &order, int Particles, const char *path);
+
+// Local q4, q6 of each particle from the neighbours closer than r_bond,
+// found in the cell grid of the force loop (r_bond <= cell side).
+void bond_order_compute(
+  bond_order &order,
+  double *x, double *y, double *z, int Particles,
+  double r_bond, const cell_grid<3> &grid);
+
+// Adds the last values to the histograms and a line to the time series.
+void bond_order_record(
+  bond_order &order,
+  double *x, double *y, int Particles,
+  double Wall, int L, int time);
+
+// Writes the histograms in `path` and releases the arrays.
+void bond_order_close(bond_order &order, const char *path);
+
+#endif  // SRC_HEADERS_BOND_ORDER_H_
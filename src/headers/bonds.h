@@ -0,0 +1,59 @@
+#ifndef SRC_HEADERS_BONDS_H_
+#define SRC_HEADERS_BONDS_H_
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#define BOND_HARMONIC 0  // k_bond (r - r0)^2 / 2
+#define BOND_FENE 1      // -k_bond r0^2 / 2 log(1 - (r / r0)^2)
+
+// directions drawn for a bead before the farthest one is kept, and growths
+// of a chain before a crowded one is kept
+#define BOND_PLACE_DRAWS 100
+#define BOND_PLACE_GROWTHS 20
+
+// Chains of beads_per_chain consecutive particles (2 for dumbbells) with
+// bonds between neighbours along the chain and a bending potential
+// k_bend (1 - cos theta) on each angle. The bonds and angles are stored
+// contiguously chain after chain, a chain is handled by a single thread,
+// so the forces are accumulated without atomics.
+struct bond_list {
+  int beads_per_chain;
+  int chains;
+  int type;
+  double k_bond, r0, k_bend;
+  std::vector<int> bond_i, bond_j;
+  std::vector<int> angle_i, angle_j, angle_k;  // j is the middle bead
+  std::vector<int> chain_bonds, chain_angles;  // first bond/angle of a chain
+};
+
+// Reads polymer.txt (beads per chain, type, k_bond, r0, k_bend), returns
+// false, with no beads per chain, when the file does not exist or
+// Particles is not a multiple of the number of beads per chain.
+bool bond_list_setup(bond_list &bonds, FILE *file, int Particles);
+
+// Bonded pairs are excluded from the non-bonded interactions.
+inline bool bond_list_excluded(int beads_per_chain, int k, int j) {
+  return beads_per_chain > 1 && k / beads_per_chain == j / beads_per_chain \
+    && (k - j == 1 || j - k == 1);
+}
+
+// Random walk of bond length from the first bead of each chain, inside the
+// cylinder. The first beads are the Poisson-disk samples, the other beads
+// are at least 1.5 L away from every bead placed before them but their
+// predecessor (cell grid of 1.5 L); a chain that cannot be grown so is
+// grown again, and the number of beads still closer is printed.
+void bond_list_place(
+  const bond_list &bonds, double *x, double *y, double *z,
+  double Wall, double height, double L,
+  std::default_random_engine &generator);
+
+// Displacement delta * F of the beads under the bonded forces, capped at
+// 0.1 L per step. The WCA of the FENE bonds has the epsilon and the
+// diameter L of the run.
+void bond_list_apply(
+  const bond_list &bonds, double *x, double *y, double *z, double delta,
+  double epsilon, double L);
+
+#endif  // SRC_HEADERS_BONDS_H_
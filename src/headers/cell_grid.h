@@ -0,0 +1,138 @@
+#ifndef SRC_HEADERS_CELL_GRID_H_
+#define SRC_HEADERS_CELL_GRID_H_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Uniform grid of cells of side >= cutoff, templated on the dimension (2 or 3).
+// The particle indices are sorted by cell (counting sort), the neighbours of
+// a particle are then found in its own cell and the adjacent ones.
+template <int Dim>
+struct cell_grid {
+  int n[Dim];                   // number of cells per direction
+  double lower[Dim];            // lower corner of the grid
+  double inverse_size;          // inverse of the cell side
+  std::vector<int> cell_start;  // first entry of each cell in particles
+  std::vector<int> particles;   // particle indices sorted by cell
+  std::vector<int> cell_of;     // cell of each particle
+};
+
+// Grid covering [lower, upper] with cells of side at least `size`.
+template <int Dim>
+void cell_grid_setup(
+  cell_grid<Dim> &grid, const double *lower, const double *upper,
+  double size) {
+  int cells = 1;
+  for (int d = 0; d < Dim; d++) {
+    grid.n[d] = std::max(1, static_cast<int>((upper[d] - lower[d]) / size));
+    grid.lower[d] = lower[d];
+    cells *= grid.n[d];
+  }
+  // same side in every direction, the largest one needed
+  double side = size;
+  for (int d = 0; d < Dim; d++) {
+    side = std::max(side, (upper[d] - lower[d]) / grid.n[d]);
+  }
+  grid.inverse_size = 1.0 / side;
+  grid.cell_start.assign(cells + 1, 0);
+}
+
+// Cell coordinate of a position along direction d, particles outside the
+// grid (before the walls are applied) go in the boundary cells.
+template <int Dim>
+inline int cell_grid_coordinate(
+  const cell_grid<Dim> &grid, double position, int d) {
+  int c = static_cast<int>(floor((position - grid.lower[d]) \
+    * grid.inverse_size));
+  return std::min(std::max(c, 0), grid.n[d] - 1);
+}
+
+// position(k, d) returns the d-th coordinate of particle k, whatever the
+// storage of the particles
+template <int Dim, typename Position>
+void cell_grid_build_from(
+  cell_grid<Dim> &grid, int Particles, Position position) {
+  grid.cell_of.resize(Particles);
+  grid.particles.resize(Particles);
+  int cells = static_cast<int>(grid.cell_start.size()) - 1;
+
+#pragma omp parallel for simd
+  for (int k = 0; k < Particles; k++) {
+    int cell = 0;
+    for (int d = Dim - 1; d >= 0; d--) {
+      cell = cell * grid.n[d] \
+        + cell_grid_coordinate(grid, position(k, d), d);
+    }
+    grid.cell_of[k] = cell;
+  }
+
+  // counting sort
+  std::fill(grid.cell_start.begin(), grid.cell_start.end(), 0);
+  for (int k = 0; k < Particles; k++) {
+    grid.cell_start[grid.cell_of[k] + 1] += 1;
+  }
+  for (int c = 0; c < cells; c++) {
+    grid.cell_start[c + 1] += grid.cell_start[c];
+  }
+  std::vector<int> fill(grid.cell_start.begin(), grid.cell_start.end() - 1);
+  for (int k = 0; k < Particles; k++) {
+    grid.particles[fill[grid.cell_of[k]]++] = k;
+  }
+}
+
+// position[d] points to the array of the d-th coordinate
+template <int Dim>
+void cell_grid_build(
+  cell_grid<Dim> &grid, double *const *position, int Particles) {
+  cell_grid_build_from(grid, Particles, [position](int k, int d) {
+    return position[d][k];
+  });
+}
+
+// Calls f(begin, end) for the cell of k and each adjacent cell, the
+// particles of a cell are particles[begin], ..., particles[end - 1] (k
+// included for its own cell).
+template <int Dim, typename Function>
+inline void cell_grid_for_each_neighbour_cell(
+  const cell_grid<Dim> &grid, int k, Function f) {
+  int c[Dim];
+  int cell = grid.cell_of[k];
+  for (int d = 0; d < Dim; d++) {
+    c[d] = cell % grid.n[d];
+    cell /= grid.n[d];
+  }
+  int low[3] = {0, 0, 0}, high[3] = {0, 0, 0};
+  for (int d = 0; d < Dim; d++) {
+    low[d] = std::max(c[d] - 1, 0);
+    high[d] = std::min(c[d] + 1, grid.n[d] - 1);
+  }
+  for (int c2 = low[2]; c2 <= high[2]; c2++) {
+    for (int c1 = low[1]; c1 <= high[1]; c1++) {
+      for (int c0 = low[0]; c0 <= high[0]; c0++) {
+        int neighbour_cell = c0 + grid.n[0] * c1;
+        if constexpr (Dim == 3) {
+          neighbour_cell += grid.n[0] * grid.n[1] * c2;
+        }
+        f(grid.cell_start[neighbour_cell], grid.cell_start[neighbour_cell + 1]);
+      }
+    }
+  }
+}
+
+// Calls f(j) for every particle j != k in the cell of k and the adjacent
+// cells, i.e. every candidate within one cell side of k.
+template <int Dim, typename Function>
+inline void cell_grid_for_each_neighbour(
+  const cell_grid<Dim> &grid, int k, Function f) {
+  cell_grid_for_each_neighbour_cell(grid, k, [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      int j = grid.particles[i];
+      if (j != k) {
+        f(j);
+      }
+    }
+  });
+}
+
+#endif  // SRC_HEADERS_CELL_GRID_H_
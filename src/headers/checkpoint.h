@@ -0,0 +1,52 @@
+#ifndef SRC_HEADERS_CHECKPOINT_H_
+#define SRC_HEADERS_CHECKPOINT_H_
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+// Binary snapshot of the state (positions, orientations, time of the next
+// step to integrate), of the seed of the counter-based generator and of the
+// `field_values` values of the chemical field (NULL and 0 without), written
+// to `path` through a temporary file and a rename so that an unfinished
+// checkpoint is never visible. The run from a checkpoint is deterministic.
+bool checkpoint_write(
+  const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time, uint64_t seed,
+  const double *field, size_t field_values);
+
+// The arrays must hold Particles entries, returns false when the file does
+// not exist or was written for another number of particles or another
+// chemical field.
+bool checkpoint_read(
+  const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int &time, uint64_t &seed,
+  double *field, size_t field_values);
+
+// Time of the next step of the checkpoint, without reading the state.
+bool checkpoint_time(const char *path, int &time);
+
+// Checkpoint children still writing, at most max_children at a time.
+struct checkpoint_children {
+  std::vector<pid_t> running;
+  int max_children;
+  int completed;
+  int failed;
+};
+
+// The child process writes the copy-on-write image of the state while the
+// caller continues immediately. Blocks only when max_children are running,
+// writes synchronously if fork() fails.
+void checkpoint_fork(
+  checkpoint_children &children, const char *path,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time, uint64_t seed,
+  const double *field, size_t field_values);
+
+// Collects the finished children, waits for all of them if `wait_all`.
+void checkpoint_reap(checkpoint_children &children, bool wait_all);
+
+#endif  // SRC_HEADERS_CHECKPOINT_H_
@@ -0,0 +1,46 @@
+#ifndef SRC_HEADERS_CHEMICAL_FIELD_H_
+#define SRC_HEADERS_CHEMICAL_FIELD_H_
+
+#include <stdio.h>
+
+#define CHEMICAL_BLOCK_Y 16  // cache blocking of the stencil in y and z,
+#define CHEMICAL_BLOCK_Z 8   // x rows are streamed
+
+// Concentration produced by the particles, diffusing and decaying on a grid
+// over the cylinder: dc/dt = D lap(c) - decay c + production sum delta(r - r_k).
+// The gradient reorients e (chi) and biases the motion (mu).
+struct chemical_field {
+  int n[3];           // nodes per direction, without the ghost layer
+  double lower[3];    // position of the first node
+  double h;           // grid spacing
+  double *c, *c_next;  // (n[0] + 2) * (n[1] + 2) * (n[2] + 2) with ghosts
+  double D, decay, production;
+  double chi, mu;
+  int substeps;       // explicit sub-steps per time step
+};
+
+// Reads chemical_field.txt (D, decay, production, chi, mu, spacing, substeps),
+// returns false when the file does not exist. The number of sub-steps is
+// raised if needed for the stability of the explicit scheme.
+bool chemical_field_setup(
+  chemical_field &field, FILE *file,
+  double Wall, double height, double delta);
+
+// Deposits the production of the particles (trilinear weights) and advances
+// the field by delta.
+void chemical_field_update(
+  chemical_field &field,
+  double *x, double *y, double *z, int Particles, double delta);
+
+// Chemotactic reorientation of e and drift along the interpolated gradient.
+void chemical_field_couple(
+  const chemical_field &field,
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, int Particles, double delta);
+
+// Values of the state c (ghost layers included), saved in checkpoints.
+size_t chemical_field_values(const chemical_field &field);
+
+void chemical_field_free(chemical_field &field);
+
+#endif  // SRC_HEADERS_CHEMICAL_FIELD_H_
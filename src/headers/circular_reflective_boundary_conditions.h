@@ -0,0 +1,12 @@
+#include <time.h>
+#include <stdio.h>
+#include <omp.h>  // import library to use pragma
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <cmath>
+
+void circular_reflective_boundary_conditions(
+  double *x, double *y, int Particles,
+  double Wall
+);
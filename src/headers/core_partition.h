@@ -0,0 +1,35 @@
+#ifndef SRC_HEADERS_CORE_PARTITION_H_
+#define SRC_HEADERS_CORE_PARTITION_H_
+
+#include <vector>
+
+// CPUs this process may run on, grouped by NUMA node (a single node when
+// /sys/devices/system/node is not available)
+struct numa_topology {
+  std::vector<std::vector<int>> nodes;
+  int cpus;
+};
+
+void numa_topology_read(numa_topology &topology);
+
+// Split of the cores between concurrent replicas (groups) and the threads
+// of each replica. The CPUs of a group are in one NUMA node, except for the
+// single group of all the CPUs.
+struct core_partition {
+  int groups;
+  int threads;  // per group
+  std::vector<std::vector<int>> group_cpus;
+};
+
+// Splits with powers of two threads per group and the whole node, dividing
+// the CPUs of every node evenly, then one group of all the CPUs. Only one
+// thread per group with the work-stealing runtime, whose parallel_for runs
+// inline inside a replica.
+std::vector<core_partition> core_partition_candidates(
+  const numa_topology &topology);
+
+// Binds the calling thread to the CPUs of group g, the threads it starts
+// (the team of its replica) inherit them.
+void core_partition_pin(const core_partition &partition, int g);
+
+#endif  // SRC_HEADERS_CORE_PARTITION_H_
@@ -0,0 +1,43 @@
+#ifndef SRC_HEADERS_COUNTER_RNG_H_
+#define SRC_HEADERS_COUNTER_RNG_H_
+
+#include <stdint.h>
+#include <cmath>
+
+// Counter-based random numbers: a draw is a hash of (seed, step, particle,
+// stream) instead of the next value of a shared generator. The noise of a
+// step does not depend on the threads or on the order of the draws, and a
+// run restarted from a checkpoint (state, time, seed) is the same run.
+#define COUNTER_RNG_ORIENTATION 0  // streams 0, 1, 2 for ex, ey, ez
+#define COUNTER_RNG_POSITION 3     // streams 3, 4, 5 for x, y, z
+
+// splitmix64 finaliser
+inline uint64_t counter_rng_mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t counter_rng_bits(
+  uint64_t seed, uint64_t step, uint64_t particle, uint64_t stream) {
+  uint64_t h = counter_rng_mix(seed + 0x9E3779B97F4A7C15ULL * (stream + 1));
+  h = counter_rng_mix(h ^ (step * 0xD1B54A32D192ED03ULL));
+  return counter_rng_mix(h ^ (particle * 0xAEF17502108EF2D9ULL));
+}
+
+// Uniform in [0, 1)
+inline double counter_rng_uniform(
+  uint64_t seed, uint64_t step, uint64_t particle, uint64_t stream) {
+  return (counter_rng_bits(seed, step, particle, stream) >> 11) \
+    * (1.0 / 9007199254740992.0);
+}
+
+// Standard normal, Box-Muller on the two halves of stream (2 s, 2 s + 1)
+inline double counter_rng_gaussian(
+  uint64_t seed, uint64_t step, uint64_t particle, uint64_t stream) {
+  double u1 = 1.0 - counter_rng_uniform(seed, step, particle, 2 * stream);
+  double u2 = counter_rng_uniform(seed, step, particle, 2 * stream + 1);
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+#endif  // SRC_HEADERS_COUNTER_RNG_H_
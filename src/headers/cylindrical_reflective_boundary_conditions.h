@@ -1,3 +1,6 @@
+#ifndef SRC_HEADERS_CYLINDRICAL_REFLECTIVE_BOUNDARY_CONDITIONS_H_
+#define SRC_HEADERS_CYLINDRICAL_REFLECTIVE_BOUNDARY_CONDITIONS_H_
+
 #include <time.h>
 #include <stdio.h>
 #include <omp.h>  // import library to use pragma
@@ -6,7 +9,59 @@
 #include <cstring>
 #include <cmath>
 
+#include "thread_pool.h"
+#include "particle_layout.h"
+
+// Reflection of a single particle on the cylinder (side wall and caps),
+// shared by the generic kernel and the fixed-size engine.
+inline void cylindrical_reflect_particle(
+  double &x, double &y, double &z,
+  double Wall_squared, double height, double height_L, int L) {
+  // x-y coordidnate circle
+  double distance_squared = x * x + y * y;
+  if (distance_squared > Wall_squared) {
+    x = (sqrt(Wall_squared) / sqrt(distance_squared)) * x;
+    y = (sqrt(Wall_squared) / sqrt(distance_squared)) * y;
+  }
+  // z coordinate
+  double D_AW_z = 0.0;
+  if (std::abs(z) > height_L) {
+    D_AW_z = std::abs(z + height);
+    if (D_AW_z > 4.0 * L) {
+      if (z > height_L) {
+        z = height - 2.0 * L;
+      } else if (z < -height_L) {
+        z = 2.0 * L - height;
+      }
+    } else {
+      if (z > height_L) {
+        z -= 2.0 * D_AW_z;
+      } else if (z < -height_L) {
+        z += 2.0 * D_AW_z;
+      }
+    }
+  }
+}
+
+// Boundary conditions on any particle layout (headers/particle_layout.h)
+template <typename Layout>
+void cylindrical_reflective_boundary_conditions_layout(
+  const Layout &p, int Particles, double Wall, double height, int L) {
+    double Wall_squared = Wall * Wall;
+    double height_L = height - L / 2.0;
+    parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+#pragma omp simd
+      for (int k = lo; k < hi; k++) {
+        cylindrical_reflect_particle(
+          p.at(PARTICLE_X, k), p.at(PARTICLE_Y, k), p.at(PARTICLE_Z, k),
+          Wall_squared, height, height_L, L);
+      }
+    });
+}
+
 void cylindrical_reflective_boundary_conditions(
   double *x, double *y, double *z, int Particles,
   double Wall, double height, int L
 );
+
+#endif  // SRC_HEADERS_CYLINDRICAL_REFLECTIVE_BOUNDARY_CONDITIONS_H_
@@ -0,0 +1,44 @@
+#ifndef SRC_HEADERS_EXTERNAL_FIELD_H_
+#define SRC_HEADERS_EXTERNAL_FIELD_H_
+
+#include <stdio.h>
+
+// External potentials and torque on each particle, evaluated in the passes
+// of update_position (policy external_forces):
+// - gravity: sedimentation velocity v_g along -z;
+// - harmonic trap of stiffness k (over the friction) around a centre,
+//   drift -k (r - centre);
+// - gravitactic (bottom-heavy) torque, e relaxes towards +z at rate
+//   1 / tau_g: de/dt = (z - (e.z) e) / tau_g.
+// And the imposed flow (policy poiseuille_flow): Poiseuille flow along the
+// axis of the cylinder of radius R, u_z = u_max (1 - rho^2 / R^2), which
+// advects the particles and rotates e with half its vorticity,
+// de/dt = (omega x e) / 2, omega = 2 u_max / R^2 (-y, x, 0).
+struct external_field {
+  double sedimentation;  // v_g
+  double trap;           // k, 0 without trap
+  double centre[3];
+  double gravitaxis;     // 1 / tau_g
+  double flow;           // u_max, 0 without flow
+  double radius;         // R
+};
+
+// Reads external_field.txt (v_g, k, centre x, y, z, 1 / tau_g), returns
+// false when the file does not exist.
+bool external_field_setup(external_field &field, FILE *file);
+
+// Reads poiseuille_flow.txt (u_max) for a cylinder of radius Wall, returns
+// false when the file does not exist.
+bool external_field_setup_flow(external_field &field, FILE *file, double Wall);
+
+// true if one of the forces or the torque is not zero
+inline bool external_field_active(const external_field *field) {
+  return field != NULL && (field->sedimentation != 0.0 \
+    || field->trap != 0.0 || field->gravitaxis != 0.0);
+}
+
+inline bool external_field_flow(const external_field *field) {
+  return field != NULL && field->flow != 0.0;
+}
+
+#endif  // SRC_HEADERS_EXTERNAL_FIELD_H_
@@ -0,0 +1,47 @@
+#ifndef SRC_HEADERS_FLIGHT_RECORDER_H_
+#define SRC_HEADERS_FLIGHT_RECORDER_H_
+
+#include <vector>
+
+#include "cell_grid.h"
+
+// The last `frames` steps at full resolution, kept in memory and written to
+// ./data/flight_<step>_<event>.csv (format of simulation.csv, oldest frame
+// first) when an event happens:
+// - cluster: a cell of side `cutoff` holds `cluster` particles or more;
+// - escape: a particle is outside the cylinder after the walls;
+// - nan: a coordinate is not finite, the run cannot go on.
+// Cluster and escape fire when their condition appears, not again while it
+// lasts. The events of one step give one dump, named after all of them
+// (flight_<step>_escape-cluster.csv). A dump holds the frames of the buffer not written by the previous
+// one, no frame is written twice.
+struct flight_recorder {
+  int frames;
+  int Particles;
+  double *data;            // frames slots of 6 * Particles values
+  std::vector<int> time;   // step of each slot
+  long recorded;           // the last frame is in slot (recorded - 1) % frames
+  long dumped;             // recorded at the last dump
+  int cluster;             // 0 disables the cluster event
+  double Wall, height;
+  cell_grid<3> grid;       // cells of the cluster event
+  std::vector<int> occupancy;  // counted in parallel, atomically
+  bool clustered, escaped;  // at the last step
+  int dumps;
+};
+
+// Allocates the buffer (48 bytes per particle and frame).
+void flight_recorder_open(
+  flight_recorder &recorder, int frames, int Particles, int cluster,
+  double Wall, double height, double cutoff);
+
+// Records the state at the end of step `time` and writes the buffer on an
+// event. Returns false when the state is not finite.
+bool flight_recorder_step(
+  flight_recorder &recorder,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int time);
+
+void flight_recorder_close(flight_recorder &recorder);
+
+#endif  // SRC_HEADERS_FLIGHT_RECORDER_H_
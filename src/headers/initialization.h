@@ -6,6 +6,9 @@
 #include <cstring>
 #include <cmath>
 
+#include "counter_rng.h"
+#include "thread_pool.h"
+
 
 void initialization(
   double *x, double *y, double *z,
@@ -14,3 +17,9 @@ void initialization(
   std::default_random_engine &generator,
   std::uniform_real_distribution<double> &distribution,
   std::uniform_real_distribution<double> &distribution_e);
+
+void initialization_2D(
+  double *x, double *y, double *theta,
+  int Particles, int L,
+  std::default_random_engine &generator,
+  std::uniform_real_distribution<double> &distribution);
@@ -0,0 +1,133 @@
+#ifndef SRC_HEADERS_INTEGRATOR_POLICIES_H_
+#define SRC_HEADERS_INTEGRATOR_POLICIES_H_
+
+#include <stdint.h>
+
+#include "bonds.h"
+#include "counter_rng.h"
+
+// Features of update_position_layout selected at compile time. A disabled
+// feature is a policy whose `enabled` is false: its code is discarded by
+// `if constexpr` and leaves no branch in the loops.
+
+// Pair potential: magnitude of the force prefactor at R2 < r^2
+struct capped_repulsion {
+  static constexpr bool enabled = true;
+  static inline double force(double R2, double prefactor_interaction) {
+    double R6 = R2 * R2 * R2;
+    double a = prefactor_interaction / (R6 * R6 * R2);  // 1 / R^14
+    if (a > 1.0) {
+      a = 1.0;  // this value needs to be checked
+    }
+    return a;
+  }
+};
+
+// Ideal active particles, no pair search at all
+struct no_interaction {
+  static constexpr bool enabled = false;
+  static inline double force(double, double) {
+    return 0.0;
+  }
+};
+
+// Density dependent self-propulsion (quorum sensing)
+struct quorum_sensing {
+  static constexpr bool enabled = true;
+};
+
+struct no_quorum {
+  static constexpr bool enabled = false;
+};
+
+// Bonded neighbours along chains do not interact
+struct chain_exclusion {
+  static constexpr bool enabled = true;
+  static inline bool excluded(int beads_per_chain, int k, int j) {
+    return bond_list_excluded(beads_per_chain, k, j);
+  }
+};
+
+struct no_bonds {
+  static constexpr bool enabled = false;
+  static inline bool excluded(int, int, int) {
+    return false;
+  }
+};
+
+// Rotational (uniform) and translational (Gaussian) noise of a step
+struct counter_noise {
+  static constexpr bool enabled = true;
+  static inline double orientation(
+    uint64_t seed, int time, int k, int component) {
+    return counter_rng_uniform(
+      seed, time, k, COUNTER_RNG_ORIENTATION + component);
+  }
+  static inline double position(
+    uint64_t seed, int time, int k, int component) {
+    return counter_rng_gaussian(
+      seed, time, k, COUNTER_RNG_POSITION + component);
+  }
+};
+
+// Athermal runs (Dt = De = 0), nothing drawn
+struct no_noise {
+  static constexpr bool enabled = false;
+  static inline double orientation(uint64_t, int, int, int) {
+    return 0.0;
+  }
+  static inline double position(uint64_t, int, int, int) {
+    return 0.0;
+  }
+};
+
+// Gravity, harmonic trap and gravitactic torque (headers/external_field.h),
+// added in the orientation and position passes
+struct external_forces {
+  static constexpr bool enabled = true;
+};
+
+struct no_external {
+  static constexpr bool enabled = false;
+};
+
+// Poiseuille flow along the axis: advection in the position pass, rotation
+// by the vorticity in the orientation pass
+struct poiseuille_flow {
+  static constexpr bool enabled = true;
+};
+
+struct no_flow {
+  static constexpr bool enabled = false;
+};
+
+// Sub-steps of the particles in close contact (headers/local_time_stepping.h)
+// in the interaction pass, needs the pair potential
+struct sub_stepping {
+  static constexpr bool enabled = true;
+};
+
+struct no_substeps {
+  static constexpr bool enabled = false;
+};
+
+template <typename Potential, typename Quorum, typename Bonds,
+  typename Noise, typename External = no_external, typename Flow = no_flow,
+  typename Substeps = no_substeps>
+struct integrator_policies {
+  static_assert(!Substeps::enabled || Potential::enabled,
+    "sub-stepping needs the pair potential");
+  typedef Potential potential;
+  typedef Quorum quorum;
+  typedef Bonds bonds;
+  typedef Noise noise;
+  typedef External external;
+  typedef Flow flow;
+  typedef Substeps substeps;
+};
+
+// The plain ABP in the cylinder, the case run most
+typedef integrator_policies<capped_repulsion, no_quorum, no_bonds,
+  counter_noise> abp_policies;
+
+#endif  // SRC_HEADERS_INTEGRATOR_POLICIES_H_
@@ -0,0 +1,37 @@
+#ifndef SRC_HEADERS_LOCAL_TIME_STEPPING_H_
+#define SRC_HEADERS_LOCAL_TIME_STEPPING_H_
+
+#include <stdio.h>
+
+// Individual sub-stepping of the stiff particles in update_position (policy
+// sub_stepping). A particle is stiff at a step when a neighbour is closer
+// than `contact` or when the sum of its pair terms is above `force`; it
+// then advances by `substeps` sub-steps of delta / substeps, its force
+// evaluated again at each one against the neighbours held at their
+// positions of the beginning of the step. The other particles take the
+// coarse step. The noise of the step is spread evenly over the sub-steps,
+// so the run stays a function of the seed.
+struct local_time_stepping {
+  int substeps;
+  double contact;
+  double force;
+  double *x, *y, *z;  // end of the step of a stiff particle
+  char *stiff;        // of the last step
+  long substepped;    // stiff particle-steps, for the summary
+};
+
+// Reads local_time_stepping.txt (substeps, contact, force), returns false
+// when the file does not exist.
+bool local_time_stepping_setup(
+  local_time_stepping &stepping, FILE *file, int Particles);
+
+inline bool local_time_stepping_active(const local_time_stepping *stepping) {
+  return stepping != NULL && stepping->substeps > 1;
+}
+
+// Adds the stiff particles of the last step to `substepped`.
+void local_time_stepping_count(local_time_stepping &stepping, int Particles);
+
+void local_time_stepping_free(local_time_stepping &stepping);
+
+#endif  // SRC_HEADERS_LOCAL_TIME_STEPPING_H_
@@ -0,0 +1,48 @@
+#ifndef SRC_HEADERS_NEIGHBOUR_DIAGNOSTICS_H_
+#define SRC_HEADERS_NEIGHBOUR_DIAGNOSTICS_H_
+
+#include <stdio.h>
+
+#include "cell_grid.h"
+
+#define DIAGNOSTICS_BINS 128  // neighbours / cell occupancy, last bin: more
+
+// double lanes of the widest vector unit the build targets
+#if defined(__AVX512F__)
+#define DIAGNOSTICS_LANES 8
+#elif defined(__AVX__)
+#define DIAGNOSTICS_LANES 4
+#else
+#define DIAGNOSTICS_LANES 2
+#endif
+
+// Statistics of the pair search of update_position, to tune the cell side
+// and the cutoff: neighbours per particle, particles per cell, candidates
+// visited in the adjacent cells and those inside the cutoff. The pair loop
+// of update_position is scalar, the lane utilisation is modelled, not
+// measured: were the contiguous candidates of a cell processed
+// DIAGNOSTICS_LANES at a time, the fraction of the lanes holding a
+// candidate, and the useful one the fraction holding a pair inside the
+// cutoff.
+struct neighbour_diagnostics {
+  long histogram_neighbours[DIAGNOSTICS_BINS];
+  long histogram_occupancy[DIAGNOSTICS_BINS];
+  long candidates, pairs, lanes;  // accumulated over the samples
+  int samples;
+  FILE *series;
+};
+
+void neighbour_diagnostics_open(
+  neighbour_diagnostics &diagnostics, const char *path);
+
+// Rebuilds the grid on the current positions and adds one sample.
+void neighbour_diagnostics_record(
+  neighbour_diagnostics &diagnostics,
+  double *x, double *y, double *z, int Particles,
+  double cutoff, cell_grid<3> &grid, int time);
+
+// Writes the histograms in `path` and prints the averages.
+void neighbour_diagnostics_close(
+  neighbour_diagnostics &diagnostics, const char *path);
+
+#endif  // SRC_HEADERS_NEIGHBOUR_DIAGNOSTICS_H_
@@ -0,0 +1,83 @@
+#ifndef SRC_HEADERS_OBSERVER_PIPELINE_H_
+#define SRC_HEADERS_OBSERVER_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// State of the particles at the end of a step, never modified once taken.
+// The observers of the step share it through a snapshot handle, it is
+// released with the last of them.
+struct observer_snapshot {
+  int time;
+  int Particles;
+  double *x, *y, *z, *ex, *ey, *ez;
+  std::vector<double> data;  // the six arrays, empty for a synchronous view
+};
+typedef std::shared_ptr<const observer_snapshot> observer_snapshot_handle;
+
+// In-situ analysis with its state, without std::function
+typedef void (*observer_function)(
+  void *context, const observer_snapshot &snapshot);
+
+struct observer {
+  const char *name;
+  int every;  // steps between two samples
+  observer_function run;
+  void *context;
+  bool running;  // the samples of an observer run one at a time, in order
+  long completed, dropped, stale;
+  double seconds;
+};
+
+struct observer_job {
+  int observer;
+  observer_snapshot_handle snapshot;
+};
+
+// Observers running on `threads` spare threads, off the time loop. The loop
+// copies the state in a snapshot when an observer is due and goes on, it
+// never waits for an analysis:
+// - budget: snapshots queued or being analysed at most (memory, 48 bytes
+//   per particle each), the samples due when it is reached are dropped;
+// - staleness: a sample older than `staleness` steps when a thread is free
+//   for it is skipped (0: no limit), so the analyses follow the run instead
+//   of falling further behind.
+// With 0 threads the observers run in the loop on the live arrays, as
+// before.
+struct observer_pipeline {
+  std::vector<observer> observers;
+  std::vector<std::thread> threads;
+  std::mutex lock;
+  std::condition_variable ready;
+  std::deque<observer_job> queue;
+  int budget;
+  int staleness;
+  int snapshots;  // alive, queued or being analysed
+  std::atomic<int> time;  // last step of the loop
+  bool stop;
+};
+
+void observer_add(
+  observer_pipeline &pipeline, const char *name, int every,
+  observer_function run, void *context);
+
+// Call after the observers are added.
+void observer_pipeline_start(
+  observer_pipeline &pipeline, int threads, int budget, int staleness);
+
+// End of step `time` of the loop: samples the observers due.
+void observer_pipeline_step(
+  observer_pipeline &pipeline,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time);
+
+// Analyses the samples still queued, joins the threads and prints the
+// samples completed, dropped and stale of each observer.
+void observer_pipeline_stop(observer_pipeline &pipeline);
+
+#endif  // SRC_HEADERS_OBSERVER_PIPELINE_H_
@@ -0,0 +1,29 @@
+#ifndef SRC_HEADERS_OUTPUT_BACKEND_H_
+#define SRC_HEADERS_OUTPUT_BACKEND_H_
+
+#include <stdio.h>
+
+#include "uring_writer.h"
+
+// Destination of the trajectories: stdio (default) or io_uring with O_DIRECT.
+// Both write the same csv text.
+struct output_backend {
+  FILE *datacsv;        // stdio path, NULL with io_uring
+  uring_writer *uring;  // io_uring path, NULL with stdio
+};
+
+// Falls back to stdio when io_uring is requested but not available.
+void output_backend_open(
+  output_backend &output, const char *path, bool use_uring);
+
+void output_backend_print(output_backend &output, const char *text);
+
+void output_backend_frame(
+  output_backend &output,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time);
+
+// Returns false when the trajectories could not be written entirely.
+bool output_backend_close(output_backend &output);
+
+#endif  // SRC_HEADERS_OUTPUT_BACKEND_H_
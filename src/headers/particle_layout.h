@@ -0,0 +1,78 @@
+#ifndef SRC_HEADERS_PARTICLE_LAYOUT_H_
+#define SRC_HEADERS_PARTICLE_LAYOUT_H_
+
+#include <stdlib.h>
+#include <cstring>
+
+// Components of a particle, in the order of the layouts below
+#define PARTICLE_X 0
+#define PARTICLE_Y 1
+#define PARTICLE_Z 2
+#define PARTICLE_EX 3
+#define PARTICLE_EY 4
+#define PARTICLE_EZ 5
+#define PARTICLE_COMPONENTS 6
+
+// Storage of the particle state seen by the layout-templated kernels through
+// at(component, k).
+
+// Structure of arrays: one array per component (x, y, z, ex, ey, ez of the
+// drivers), streaming updates read six contiguous streams.
+struct soa_layout {
+  double *component[PARTICLE_COMPONENTS];
+
+  inline double &at(int c, int k) const {
+    return component[c][k];
+  }
+};
+
+// Array of structures of arrays: blocks of Block particles, the Block
+// values of each component contiguous in the block. A neighbour's position
+// and orientation are in one block of 6 * Block doubles (6 cache lines of
+// 64 bytes for Block = 8, x, y, z in the first 3) instead of six arrays.
+template <int Block>
+struct aosoa_layout {
+  double *data;  // (Particles + Block - 1) / Block blocks, 64-byte aligned
+
+  inline double &at(int c, int k) const {
+    // unsigned: shift and mask for a power of two Block
+    unsigned i = k;
+    return data[(i / Block) * (PARTICLE_COMPONENTS * Block) + c * Block \
+      + i % Block];
+  }
+};
+
+// Copies between the drivers' arrays and a blocked buffer, the padding of
+// the last block is zero.
+template <int Block>
+aosoa_layout<Block> aosoa_allocate(int Particles) {
+  size_t bytes = sizeof(double) * PARTICLE_COMPONENTS * Block \
+    * ((Particles + Block - 1) / Block);
+  bytes = (bytes + 63) / 64 * 64;
+  aosoa_layout<Block> layout;
+  layout.data = reinterpret_cast<double*>(aligned_alloc(64, bytes));
+  memset(layout.data, 0, bytes);
+  return layout;
+}
+
+template <int Block>
+void aosoa_load(const aosoa_layout<Block> &layout, const soa_layout &soa,
+  int Particles) {
+  for (int k = 0; k < Particles; k++) {
+    for (int c = 0; c < PARTICLE_COMPONENTS; c++) {
+      layout.at(c, k) = soa.at(c, k);
+    }
+  }
+}
+
+template <int Block>
+void aosoa_store(const aosoa_layout<Block> &layout, const soa_layout &soa,
+  int Particles) {
+  for (int k = 0; k < Particles; k++) {
+    for (int c = 0; c < PARTICLE_COMPONENTS; c++) {
+      soa.at(c, k) = layout.at(c, k);
+    }
+  }
+}
+
+#endif  // SRC_HEADERS_PARTICLE_LAYOUT_H_
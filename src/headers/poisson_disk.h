@@ -0,0 +1,25 @@
+#ifndef SRC_HEADERS_POISSON_DISK_H_
+#define SRC_HEADERS_POISSON_DISK_H_
+
+#include <stdio.h>
+#include <random>
+
+#define POISSON_DISK_ROUNDS 64  // darts per cell at most
+
+// Random positions in the cylinder (at L / 2 from the walls) at least 1.5 L
+// apart, replacing the pairwise check of the initial state.
+// Parallel Poisson-disk sampling: cells of side 1.5 L / sqrt(3) hold at
+// most one sample, and a sample only conflicts with the cells at most 2
+// away. The cells are processed in 27 phases (cell coordinates modulo 3),
+// the cells of a phase are 3 apart and draw their darts concurrently. Each
+// round throws one dart, from the counter-based generator, in every empty
+// cell, until there are at least Particles samples: the result depends on
+// the seed only, in time linear in the volume. Particles of the samples are
+// kept at random, in cell order (nearby particles are close in memory).
+// Prints a message and exits when the density is too high.
+void poisson_disk_positions(
+  double *x, double *y, double *z, int Particles,
+  double Wall, double height, int L,
+  std::default_random_engine &generator);
+
+#endif  // SRC_HEADERS_POISSON_DISK_H_
@@ -9,3 +9,8 @@ void print_file(
   double *x, double *y, double *z, double *ex, double *ey, double *ez,
   int Particles, int time,
   FILE *datacsv);
+
+void print_file_2D(
+  double *x, double *y, double *theta,
+  int Particles, int time,
+  FILE *datacsv);
@@ -0,0 +1,57 @@
+#ifndef SRC_HEADERS_RESULT_CACHE_H_
+#define SRC_HEADERS_RESULT_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "run_options.h"
+
+// Local store of finished runs, addressed by a hash of their configuration:
+// parameter.txt without N, the optional input files (spherocylinder.txt,
+// quorum_sensing.txt, ...), the seed, the options that change the outputs
+// and the executable itself (any change of the code is another build).
+// An entry <root>/<key>/ holds the outputs of the run, its final checkpoint
+// and the number of steps, written last: the files are staged beside the
+// entry and renamed into it once all of them are written, the entry has no
+// steps in between. A run of as many steps is copied from the entry, a
+// longer one continues from the checkpoint, appends to the time series and
+// adds to the histograms. With the chemical field the
+// deposition order of the threads changes the round-off, an extension would
+// not be identical to a single run: a longer run is integrated from the
+// start and replaces the entry.
+struct result_cache {
+  std::string directory;
+  std::string configuration;  // text of the key, kept in the entry
+  std::vector<std::string> files;  // outputs in ./data of this configuration
+  std::vector<bool> series;   // one line per sample, appended when extending,
+                              // or a histogram whose counts are added
+  int steps;                  // steps of the entry, 0 when there is none
+  bool extendable;            // false with the chemical field or when the
+                              // checkpoint is not at the step of the entry
+};
+
+// FNV-1a, continued from `hash`
+uint64_t result_cache_hash(const void *data, size_t size, uint64_t hash);
+
+// Reads the configuration, returns false without parameter.txt. `steps`
+// is N of parameter.txt.
+bool result_cache_open(
+  result_cache &cache, const char *root, const run_options &options,
+  int &steps);
+
+// Copies the outputs of the entry into ./data.
+void result_cache_restore(const result_cache &cache);
+
+std::string result_cache_checkpoint(const result_cache &cache);
+
+// Records a run of `steps` steps, once its outputs are closed, with its
+// final state as the checkpoint: the time series continue those of the
+// entry when it is extended. Returns false, leaving the entry as it was,
+// when a file could not be staged.
+bool result_cache_store(
+  result_cache &cache, int steps,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, uint64_t seed, const double *field, size_t field_values);
+
+#endif  // SRC_HEADERS_RESULT_CACHE_H_
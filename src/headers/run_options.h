@@ -0,0 +1,33 @@
+#ifndef SRC_HEADERS_RUN_OPTIONS_H_
+#define SRC_HEADERS_RUN_OPTIONS_H_
+
+#include <stdint.h>
+
+// Command line options of abp_3D_confine, the physical parameters stay in
+// parameter.txt.
+struct run_options {
+  bool uring_output = false;  // --output=uring (default --output=stdio)
+  int checkpoint_every = 0;   // --checkpoint=<steps>, 0 disables checkpoints
+  int checkpoint_children = 2;  // --checkpoint-children=<n> writing at once
+  const char *restart = NULL;   // --restart=<checkpoint> instead of a new state
+  int bond_order_every = 0;     // --bond-order=<steps>, 0 disables q4/q6
+  int diagnostics_every = 0;    // --diagnostics=<steps>, pair search stats
+  int output_every = 10;        // --output-every=<steps>, 0 disables frames
+  int trajectory_every = 0;     // --trajectory=<steps>, binary indexed frames
+  uint64_t seed = 0;            // --seed=<n>, 0 draws one
+  const char *steer = NULL;     // --steer=<socket>, control server
+  const char *replay = NULL;    // --replay=<checkpoint>
+  int window_begin = 0;         // --window=<t0>,<t1> replayed every step
+  int window_end = -1;
+  int observer_threads = 0;     // --observers=<threads> for the analyses
+  int observer_budget = 2;      // --observer-budget=<snapshots> in flight
+  int observer_staleness = 0;   // --observer-staleness=<steps>, 0: no limit
+  const char *cache = NULL;     // --cache=<directory> of finished runs
+  int flight_frames = 0;        // --flight-recorder=<frames> kept in memory
+  int flight_cluster = 0;       // --flight-cluster=<particles> in a cell
+};
+
+// Returns false, after printing the usage, on an unknown argument.
+bool parse_run_options(int argc, char *argv[], run_options &options);
+
+#endif  // SRC_HEADERS_RUN_OPTIONS_H_
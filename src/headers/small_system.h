@@ -0,0 +1,147 @@
+#ifndef SRC_HEADERS_SMALL_SYSTEM_H_
+#define SRC_HEADERS_SMALL_SYSTEM_H_
+
+#include <array>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "cylindrical_reflective_boundary_conditions.h"
+
+// Particle counts with a compiled engine, any other count goes through
+// update_position and cylindrical_reflective_boundary_conditions.
+using small_system_counts = std::integer_sequence<int,
+  2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 24, 32, 48, 64>;
+
+// Fixed-size state, the particle count is known at compile time so every
+// loop below has a constant trip count and is unrolled by the compiler.
+template <int N>
+struct small_system {
+  std::array<double, N> x, y, z;
+  std::array<double, N> ex, ey, ez;
+};
+
+// Time evolution of one small system over `steps` iterations.
+// Same Euler-Mayurama scheme as update_position followed by
+// cylindrical_reflective_boundary_conditions, but each pair is visited once
+// and the forces are computed from the positions at the start of the step.
+template <int N>
+void small_system_run(
+  small_system<N> &state, int steps,
+  double prefactor_e, double vs, double delta,
+  double prefactor_xi_p,
+  double r, double prefactor_interaction,
+  double Wall, double height, int L,
+  std::default_random_engine &generator,
+  std::normal_distribution<double> &Gaussdistribution,
+  std::uniform_real_distribution<double> &distribution_e) {
+  // local copy, keeps the state out of memory during the time loop
+  small_system<N> s = state;
+  std::array<double, N> F;
+  const double r_squared = r * r;
+  const double Wall_squared = Wall * Wall;
+  const double height_L = height - L / 2.0;
+
+  for (int time = 0; time < steps; time++) {
+    // First orientation
+#pragma GCC unroll 16
+    for (int k = 0; k < N; k++) {
+      double xi_ex = distribution_e(generator);
+      double xi_ey = distribution_e(generator);
+      double xi_ez = distribution_e(generator);
+
+      // Ito formulation
+      s.ex[k] = prefactor_e * (s.ey[k] * xi_ez - xi_ez * s.ez[k]) - s.ex[k];
+      s.ey[k] = prefactor_e * (s.ex[k] * xi_ez - xi_ex * s.ez[k]) - s.ey[k];
+      s.ez[k] = prefactor_e * (s.ex[k] * xi_ey - xi_ex * s.ey[k]) - s.ez[k];
+
+      double invers_norm_e = 1.0 / sqrt(s.ex[k] * s.ex[k] \
+        + s.ey[k] * s.ey[k] + s.ez[k] * s.ez[k]);
+      s.ex[k] *= invers_norm_e;
+      s.ey[k] *= invers_norm_e;
+      s.ez[k] *= invers_norm_e;
+    }
+
+    // Pair interactions, R^14 = (R^2)^7 and no branch on the cutoff
+    F.fill(0.0);
+#pragma GCC unroll 16
+    for (int k = 0; k < N; k++) {
+#pragma GCC unroll 16
+      for (int j = k + 1; j < N; j++) {
+        double dx = s.x[j] - s.x[k];
+        double dy = s.y[j] - s.y[k];
+        double dz = s.z[j] - s.z[k];
+        double R2 = dx * dx + dy * dy + dz * dz;
+        double R6 = R2 * R2 * R2;
+        double a = std::min(prefactor_interaction / (R6 * R6 * R2), 1.0);
+        a = (R2 < r_squared) ? a : 0.0;
+        F[k] += a;
+        F[j] += a;
+      }
+    }
+
+    // Second position, then walls
+#pragma GCC unroll 16
+    for (int k = 0; k < N; k++) {
+      double xi_px = Gaussdistribution(generator);
+      double xi_py = Gaussdistribution(generator);
+      double xi_pz = Gaussdistribution(generator);
+      s.x[k] += vs * s.ex[k] * delta \
+        + F[k] * s.x[k] * delta + xi_px * prefactor_xi_p;
+      s.y[k] += vs * s.ey[k] * delta \
+        + F[k] * s.y[k] * delta + xi_py * prefactor_xi_p;
+      s.z[k] += vs * s.ez[k] * delta \
+        + F[k] * s.z[k] * delta + xi_pz * prefactor_xi_p;
+      cylindrical_reflect_particle(
+        s.x[k], s.y[k], s.z[k], Wall_squared, height, height_L, L);
+    }
+  }
+  state = s;
+}
+
+// Runs one replica of N particles with the compile-time engine, the state is
+// read from and written back to the replica slice of the ensemble arrays.
+template <int N>
+void small_system_replica(
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez,
+  int steps, double prefactor_e, double vs, double delta,
+  double prefactor_xi_p, double r, double prefactor_interaction,
+  double Wall, double height, int L,
+  std::default_random_engine &generator,
+  std::normal_distribution<double> &Gaussdistribution,
+  std::uniform_real_distribution<double> &distribution_e) {
+  small_system<N> state;
+  for (int k = 0; k < N; k++) {
+    state.x[k] = x[k];
+    state.y[k] = y[k];
+    state.z[k] = z[k];
+    state.ex[k] = ex[k];
+    state.ey[k] = ey[k];
+    state.ez[k] = ez[k];
+  }
+  small_system_run<N>(
+    state, steps, prefactor_e, vs, delta, prefactor_xi_p,
+    r, prefactor_interaction, Wall, height, L,
+    generator, Gaussdistribution, distribution_e);
+  for (int k = 0; k < N; k++) {
+    x[k] = state.x[k];
+    y[k] = state.y[k];
+    z[k] = state.z[k];
+    ex[k] = state.ex[k];
+    ey[k] = state.ey[k];
+    ez[k] = state.ez[k];
+  }
+}
+
+// Maps the runtime particle count onto the matching instantiation,
+// returns false when Particles is not one of the compiled counts.
+template <int... Counts, typename... Args>
+bool small_system_dispatch(
+  std::integer_sequence<int, Counts...>, int Particles, Args&&... args) {
+  return ((Particles == Counts
+    && (small_system_replica<Counts>(args...), true)) || ...);
+}
+
+#endif  // SRC_HEADERS_SMALL_SYSTEM_H_
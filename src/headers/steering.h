@@ -0,0 +1,43 @@
+#ifndef SRC_HEADERS_STEERING_H_
+#define SRC_HEADERS_STEERING_H_
+
+#include <string>
+#include <vector>
+
+#define STEERING_MAX_CLIENTS 8
+
+// Parameters that can be changed during a run
+struct steering_parameters {
+  double vs;
+  double De;
+  double epsilon;
+  int output_every;
+};
+
+// Control server on a Unix domain socket, every call is non-blocking and
+// made by the time loop between two steps, so the kernels never see a
+// parameter change in the middle of a step and need no lock.
+// Text protocol, one command per line, one reply line per command:
+//   set <vs|De|epsilon|output_every> <value>   -> ok | error ...
+//   get                                         -> time=... (observables)
+struct steering_server {
+  int listen_fd;
+  std::string path;
+  std::vector<int> clients;
+  std::vector<std::string> input;  // incomplete line of each client
+};
+
+// Returns false if the socket cannot be created at `path`.
+bool steering_open(steering_server &server, const char *path);
+
+// Accepts the new clients and answers the complete commands received since
+// the last call. The `set` commands are applied to `parameters` in order of
+// arrival, returns true if one of them changed.
+bool steering_poll(
+  steering_server &server, steering_parameters &parameters,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, double Wall, int L, int time);
+
+void steering_close(steering_server &server);
+
+#endif  // SRC_HEADERS_STEERING_H_
@@ -0,0 +1,61 @@
+#ifndef SRC_HEADERS_THREAD_POOL_H_
+#define SRC_HEADERS_THREAD_POOL_H_
+
+#include <omp.h>
+#include <algorithm>
+
+// parallel_for(begin, end, grain, f) calls f(lo, hi) on disjoint ranges
+// covering [begin, end), f loops over its range (with `#pragma omp simd`
+// where the loop vectorises).
+//
+// Default build: one contiguous range per OpenMP thread, as
+// `#pragma omp parallel for` with the static schedule.
+// `make RUNTIME=work_stealing` (-DABP_WORK_STEALING): the ranges run on the
+// engine's own pool of pinned workers, each with a Chase-Lev deque. A
+// worker splits its range in halves down to `grain` iterations, keeps one
+// half and pushes the other, idle workers steal the largest pending halves.
+//
+// Called from inside a parallel region (an ensemble replica, a worker of the
+// pool), the whole range runs on the calling thread, so that nested
+// parallelism never oversubscribes the cores.
+
+// Range body with its captures, without std::function
+typedef void (*thread_pool_body)(void *context, int lo, int hi);
+
+// Starts the pool on first use with omp_get_max_threads() threads (the
+// caller included), joins it at exit.
+void thread_pool_run(
+  int begin, int end, int grain, thread_pool_body body, void *context);
+
+// true on a worker of the pool
+bool thread_pool_worker();
+
+template <typename Function>
+inline void parallel_for(int begin, int end, int grain, Function f) {
+  if (end <= begin) {
+    return;
+  }
+#ifdef ABP_WORK_STEALING
+  if (omp_in_parallel() || thread_pool_worker()) {
+    f(begin, end);
+    return;
+  }
+  thread_pool_run(begin, end, std::max(grain, 1), [](
+    void *context, int lo, int hi) {
+    (*reinterpret_cast<Function*>(context))(lo, hi);
+  }, &f);
+#else
+#pragma omp parallel
+  {
+    int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+    long size = end - begin;
+    int lo = begin + static_cast<int>(size * thread / threads);
+    int hi = begin + static_cast<int>(size * (thread + 1) / threads);
+    if (lo < hi) {
+      f(lo, hi);
+    }
+  }
+#endif
+}
+
+#endif  // SRC_HEADERS_THREAD_POOL_H_
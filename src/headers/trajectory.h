@@ -0,0 +1,74 @@
+#ifndef SRC_HEADERS_TRAJECTORY_H_
+#define SRC_HEADERS_TRAJECTORY_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <vector>
+
+#include "cell_grid.h"
+
+#define TRAJECTORY_MAGIC "ABPTRAJ1"
+#define TRAJECTORY_CELLS 8  // coarse cells along the longest side
+
+// One particle of one frame
+struct trajectory_record {
+  double x, y, z, ex, ey, ez;
+  int particle;
+  int time;
+};
+
+// Binary trajectory with a coarse spatial index. After the file header,
+// every frame has the same size: its time, the offsets of the coarse cells
+// (cells + 1 ints, padded to 8 bytes) and the records sorted by cell.
+struct trajectory_header {
+  char magic[8];
+  int Particles;
+  int n[3];           // coarse cells per direction
+  double lower[3];    // lower corner of the coarse grid
+  double inverse_size;
+};
+
+struct trajectory_writer {
+  FILE *file;
+  cell_grid<3> grid;
+  std::vector<trajectory_record> records;
+};
+
+// Coarse grid over the cylinder, returns false if the file cannot be opened.
+bool trajectory_writer_open(
+  trajectory_writer &writer, const char *path,
+  int Particles, double Wall, double height);
+
+void trajectory_writer_frame(
+  trajectory_writer &writer,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time);
+
+void trajectory_writer_close(trajectory_writer &writer);
+
+// Read-only mapping of a trajectory written by trajectory_writer
+struct trajectory_reader {
+  int fd;
+  const char *map;
+  size_t size;
+  trajectory_header header;
+  int cells;
+  size_t frame_header;  // time and cell offsets, in bytes
+  size_t frame_size;
+  long frames;
+};
+
+bool trajectory_reader_open(trajectory_reader &reader, const char *path);
+
+// Appends the records inside the box [lower, upper] of the frames with
+// t0 <= time <= t1. The frames are found by bisection on the time and only
+// the coarse cells overlapping the box are touched. Returns the number of
+// records appended.
+size_t trajectory_query(
+  const trajectory_reader &reader,
+  const double *lower, const double *upper, int t0, int t1,
+  std::vector<trajectory_record> &records);
+
+void trajectory_reader_close(trajectory_reader &reader);
+
+#endif  // SRC_HEADERS_TRAJECTORY_H_
@@ -6,15 +6,69 @@
 #include <omp.h>
 #include <cmath>
 
+#include "cell_grid.h"
+#include "bonds.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+#include "update_position_layout.h"
+#include "external_field.h"
+#include "local_time_stepping.h"
+
+// Quorum sensing: a particle with at least N_qs neighbours closer than
+// r_qs (<= r) swims at vs_qs instead of vs. N_qs = INT_MAX disables it.
+// Bonded neighbours along chains of beads_per_chain particles (0 without
+// chains) do not interact. external: gravity, trap, gravitactic torque and
+// Poiseuille flow (headers/external_field.h), NULL without. substeps:
+// sub-stepping of the particles in close contact
+// (headers/local_time_stepping.h), NULL without.
+// The noise of step `time` comes from the counter-based generator of `seed`
+// and the interactions are computed from the positions at the beginning of
+// the step (force: 2 * Particles scratch values), so that a step does not
+// depend on the number of threads.
 void update_position(
   double *x, double *y, double *z,
-  double *ex, double *ey, double *ez,
+  double *ex, double *ey, double *ez, double *force,
+  double prefactor_e, int Particles,
+  double delta, double vs,
+  double prefactor_xi_px, double prefactor_xi_py, double prefactor_xi_pz,
+  double r, double prefactor_interaction,
+  double r_qs, int N_qs, double vs_qs,
+  int beads_per_chain, const external_field *external,
+  local_time_stepping *substeps, cell_grid<3> &grid,
+  uint64_t seed, int time);
+
+// update_position runs the prebuilt instantiation of update_position_layout
+// (headers/integrator_policies.h) without the features the parameters do
+// not use: the plain ABP has no quorum count and no bond test in its pair
+// loop.
+typedef void (*update_position_kernel)(
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, double *force,
   double prefactor_e, int Particles,
-  double delta, double De, double Dt,
-  double xi_ex, double xi_ey, double xi_ez, double xi_px,
-  double xi_py, double xi_pz, double vs,
+  double delta, double vs,
   double prefactor_xi_px, double prefactor_xi_py, double prefactor_xi_pz,
   double r, double prefactor_interaction,
-  std::default_random_engine &generator,
-  std::normal_distribution<double> &Gaussdistribution,
-  std::uniform_real_distribution<double> &distribution_e);
+  double r_qs, int N_qs, double vs_qs,
+  int beads_per_chain, const external_field *external,
+  local_time_stepping *substeps, cell_grid<3> &grid,
+  uint64_t seed, int time);
+
+struct update_position_variant {
+  const char *name;
+  // compiled in
+  bool interaction, quorum, bonds, noise, external, flow, substeps;
+  update_position_kernel kernel;
+};
+
+// Cheapest first, the last one has every feature
+extern const update_position_variant update_position_variants[];
+extern const int update_position_variant_count;
+
+// First variant with the features the parameters need
+const update_position_variant *update_position_select(
+  double prefactor_e, double prefactor_xi_p, double prefactor_interaction,
+  int N_qs, int beads_per_chain, const external_field *external,
+  const local_time_stepping *substeps);
+
+// NULL for an unknown name
+const update_position_variant *update_position_find(const char *name);
@@ -0,0 +1,18 @@
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <time.h>
+#include <stdio.h>
+#include <omp.h>
+#include <cmath>
+
+#include "cell_grid.h"
+#include "counter_rng.h"
+
+void update_position_2D(
+  double *x, double *y, double *theta, double *F,
+  double prefactor_e, int Particles,
+  double delta, double vs, double prefactor_xi_p,
+  double r, double prefactor_interaction,
+  cell_grid<2> &grid,
+  uint64_t seed, int time);
@@ -0,0 +1,305 @@
+#ifndef SRC_HEADERS_UPDATE_POSITION_LAYOUT_H_
+#define SRC_HEADERS_UPDATE_POSITION_LAYOUT_H_
+
+#include <stdint.h>
+#include <cmath>
+
+#include "cell_grid.h"
+#include "thread_pool.h"
+#include "particle_layout.h"
+#include "integrator_policies.h"
+#include "external_field.h"
+#include "local_time_stepping.h"
+
+// Particles whose noise is drawn ahead of a vectorised loop: the draws
+// (hash, log, cos) stay scalar, the update of the chunk has no calls nor
+// branches.
+#define UPDATE_POSITION_CHUNK 256
+
+// Step of update_position on any particle layout (soa_layout,
+// aosoa_layout<Block>), the same operations in the same order whatever the
+// layout. Policies (headers/integrator_policies.h) selects the features, the
+// arguments of a disabled one are ignored.
+template <typename Policies, typename Layout>
+void update_position_layout(
+  const Layout &p, double *force,
+  double prefactor_e, int Particles,
+  double delta, double vs,
+  double prefactor_xi_px, double prefactor_xi_py,
+  double prefactor_xi_pz,
+  double r, double prefactor_interaction,
+  double r_qs, int N_qs, double vs_qs,
+  int beads_per_chain, const external_field *external,
+  local_time_stepping *substeps, cell_grid<3> &grid,
+  uint64_t seed, int time) {
+    auto x = [&p](int k) -> double & { return p.at(PARTICLE_X, k); };
+    auto y = [&p](int k) -> double & { return p.at(PARTICLE_Y, k); };
+    auto z = [&p](int k) -> double & { return p.at(PARTICLE_Z, k); };
+    auto ex = [&p](int k) -> double & { return p.at(PARTICLE_EX, k); };
+    auto ey = [&p](int k) -> double & { return p.at(PARTICLE_EY, k); };
+    auto ez = [&p](int k) -> double & { return p.at(PARTICLE_EZ, k); };
+    typedef typename Policies::potential Potential;
+    typedef typename Policies::quorum Quorum;
+    typedef typename Policies::bonds Bonds;
+    typedef typename Policies::noise Noise;
+    typedef typename Policies::external External;
+    typedef typename Policies::flow Flow;
+    typedef typename Policies::substeps Substeps;
+    if constexpr (Substeps::enabled) {
+      if (substeps == NULL) {
+        // nothing to sub-step with, the coarse step of every particle
+        update_position_layout<integrator_policies<
+          Potential, Quorum, Bonds, Noise, External, Flow> >(
+          p, force, prefactor_e, Particles, delta, vs, prefactor_xi_px,
+          prefactor_xi_py, prefactor_xi_pz, r, prefactor_interaction,
+          r_qs, N_qs, vs_qs, beads_per_chain, external, NULL, grid, seed,
+          time);
+        return;
+      }
+    }
+    double gravitaxis_delta = 0.0, sedimentation_delta = 0.0;
+    double trap_delta = 0.0, centre[3] = {0.0, 0.0, 0.0};
+    if constexpr (External::enabled) {
+      if (external != NULL) {
+        gravitaxis_delta = external->gravitaxis * delta;
+        sedimentation_delta = external->sedimentation * delta;
+        trap_delta = external->trap * delta;
+        for (int d = 0; d < 3; d++) {
+          centre[d] = external->centre[d];
+        }
+      }
+    }
+    // u_max dt, and half the vorticity over the position times dt
+    double flow_delta = 0.0, vorticity_delta = 0.0;
+    double inverse_radius_squared = 0.0;
+    if constexpr (Flow::enabled) {
+      if (external != NULL) {
+        inverse_radius_squared = 1.0 / (external->radius * external->radius);
+        flow_delta = external->flow * delta;
+        vorticity_delta = flow_delta * inverse_radius_squared;
+      }
+    }
+
+    // First orientation
+    parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+      double xi[3][UPDATE_POSITION_CHUNK];
+      for (int first = lo; first < hi; first += UPDATE_POSITION_CHUNK) {
+        int last = hi < first + UPDATE_POSITION_CHUNK \
+          ? hi : first + UPDATE_POSITION_CHUNK;
+        for (int k = first; k < last; k++) {
+          for (int d = 0; d < 3; d++) {
+            xi[d][k - first] = Noise::orientation(seed, time, k, d);
+          }
+        }
+#pragma omp simd
+        for (int k = first; k < last; k++) {
+          double xi_ex = xi[0][k - first];
+          double xi_ey = xi[1][k - first];
+          double xi_ez = xi[2][k - first];
+
+          // Ito formulation
+          ex(k) = prefactor_e * (ey(k) * xi_ez - xi_ez * ez(k)) - ex(k);
+          ey(k) = prefactor_e * (ex(k) * xi_ez - xi_ex * ez(k)) - ey(k);
+          ez(k) = prefactor_e * (ex(k) * xi_ey - xi_ex * ey(k)) - ez(k);
+
+          if constexpr (External::enabled) {
+            // gravitactic torque towards +z
+            double e_z = ez(k);
+            ex(k) -= gravitaxis_delta * e_z * ex(k);
+            ey(k) -= gravitaxis_delta * e_z * ey(k);
+            ez(k) += gravitaxis_delta * (1.0 - e_z * e_z);
+          }
+
+          if constexpr (Flow::enabled) {
+            // (omega x e) dt / 2 with omega dt / 2 = vorticity_delta (-y, x, 0)
+            double w_x = -vorticity_delta * y(k);
+            double w_y = vorticity_delta * x(k);
+            double e_x = ex(k), e_y = ey(k), e_z = ez(k);
+            ex(k) = e_x + w_y * e_z;
+            ey(k) = e_y - w_x * e_z;
+            ez(k) = e_z + w_x * e_y - w_y * e_x;
+          }
+
+          // Need to normalize the orientaional vector
+          double norm_e = sqrt(ex(k) * ex(k) + ey(k) * ey(k) + ez(k) * ez(k));
+          double invers_norm_e = 1.0 / norm_e;
+
+          ex(k) = ex(k) * invers_norm_e;
+          ey(k) = ey(k) * invers_norm_e;
+          ez(k) = ez(k) * invers_norm_e;
+        }
+      }
+    });
+
+  // Second interactions, candidates from the cells around each particle.
+  // All of them see the positions at the beginning of the step.
+    double r_squared = r * r;
+    double r_qs_squared = r_qs * r_qs;
+    double *F = force, *vs_k = force + Particles;
+    [[maybe_unused]] double contact_squared = 0.0, stiff_force = 0.0;
+    [[maybe_unused]] int n_substeps = 1;
+    if constexpr (Substeps::enabled) {
+      contact_squared = substeps->contact * substeps->contact;
+      stiff_force = substeps->force;
+      n_substeps = substeps->substeps;
+    }
+    if constexpr (Potential::enabled) {
+      cell_grid_build_from(grid, Particles, [&p](int k, int d) {
+        return p.at(PARTICLE_X + d, k);
+      });
+      // neighbour counts vary, small ranges balance them
+      parallel_for(0, Particles, 64, [&](int lo, int hi) {
+        for (int k = lo; k < hi; k++) {
+          double F_k = 0.0;
+          // quorum sensing, counted in the same pass
+          [[maybe_unused]] int neighbours_qs = 0;
+          [[maybe_unused]] double closest = INFINITY;  // R2
+          cell_grid_for_each_neighbour(grid, k, [&](int j) {
+            if constexpr (Bonds::enabled) {
+              if (Bonds::excluded(beads_per_chain, k, j)) {
+                return;
+              }
+            }
+            double R2 = (x(j) - x(k)) * (x(j) - x(k))\
+              + (y(j) - y(k)) * (y(j) - y(k))\
+              + (z(j) - z(k)) * (z(j) - z(k));
+            if (R2 < r_squared) {
+              F_k += Potential::force(R2, prefactor_interaction);
+            }
+            if constexpr (Quorum::enabled) {
+              neighbours_qs += R2 < r_qs_squared;
+            }
+            if constexpr (Substeps::enabled) {
+              closest = R2 < closest ? R2 : closest;
+            }
+          });
+          F[k] = F_k;
+          if constexpr (Quorum::enabled) {
+            vs_k[k] = (neighbours_qs >= N_qs) ? vs_qs : vs;
+          } else {
+            vs_k[k] = vs;
+          }
+          if constexpr (Substeps::enabled) {
+            bool stiff = n_substeps > 1 \
+              && (closest < contact_squared || F_k > stiff_force);
+            substeps->stiff[k] = stiff;
+            if (!stiff) {
+              substeps->x[k] = 0.0;
+              substeps->y[k] = 0.0;
+              substeps->z[k] = 0.0;
+              continue;
+            }
+            // sub-steps against the neighbours held at the beginning of
+            // the step, their difference to the coarse step is added in the
+            // position pass
+            double h = delta / n_substeps;
+            double p[3] = {x(k), y(k), z(k)};
+            double e[3] = {ex(k), ey(k), ez(k)};
+            double prefactor_xi[3] = {prefactor_xi_px, prefactor_xi_py,
+              prefactor_xi_pz};
+            double noise[3];
+            for (int d = 0; d < 3; d++) {
+              noise[d] = Noise::position(seed, time, k, d) \
+                * prefactor_xi[d] / n_substeps;
+            }
+            double F_s = F_k;
+            for (int s = 0; s < n_substeps; s++) {
+              if (s > 0) {
+                F_s = 0.0;
+                cell_grid_for_each_neighbour(grid, k, [&](int j) {
+                  if constexpr (Bonds::enabled) {
+                    if (Bonds::excluded(beads_per_chain, k, j)) {
+                      return;
+                    }
+                  }
+                  double R2 = (x(j) - p[0]) * (x(j) - p[0])\
+                    + (y(j) - p[1]) * (y(j) - p[1])\
+                    + (z(j) - p[2]) * (z(j) - p[2]);
+                  if (R2 < r_squared) {
+                    F_s += Potential::force(R2, prefactor_interaction);
+                  }
+                });
+              }
+              for (int d = 0; d < 3; d++) {
+                p[d] += vs_k[k] * e[d] * h + F_s * p[d] * h + noise[d];
+              }
+            }
+            double coarse[3] = {x(k), y(k), z(k)};
+            for (int d = 0; d < 3; d++) {
+              coarse[d] += vs_k[k] * e[d] * delta + F_k * coarse[d] * delta \
+                + Noise::position(seed, time, k, d) * prefactor_xi[d];
+            }
+            substeps->x[k] = p[0] - coarse[0];
+            substeps->y[k] = p[1] - coarse[1];
+            substeps->z[k] = p[2] - coarse[2];
+          }
+        }
+      });
+    } else {
+      parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+        for (int k = lo; k < hi; k++) {
+          F[k] = 0.0;
+          vs_k[k] = vs;
+        }
+      });
+    }
+
+  // Third position
+  [[maybe_unused]] double *correction_x = NULL, *correction_y = NULL;
+  [[maybe_unused]] double *correction_z = NULL;
+  if constexpr (Substeps::enabled) {
+    correction_x = substeps->x;
+    correction_y = substeps->y;
+    correction_z = substeps->z;
+  }
+  parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+    double xi[3][UPDATE_POSITION_CHUNK];
+    for (int first = lo; first < hi; first += UPDATE_POSITION_CHUNK) {
+      int last = hi < first + UPDATE_POSITION_CHUNK \
+        ? hi : first + UPDATE_POSITION_CHUNK;
+      for (int k = first; k < last; k++) {
+        for (int d = 0; d < 3; d++) {
+          xi[d][k - first] = Noise::position(seed, time, k, d);
+        }
+      }
+#pragma omp simd
+      for (int k = first; k < last; k++) {
+        double xi_px = xi[0][k - first];
+        double xi_py = xi[1][k - first];
+        double xi_pz = xi[2][k - first];
+        // trap and gravity, from the position at the beginning of the step
+        [[maybe_unused]] double drift_x = 0.0, drift_y = 0.0, drift_z = 0.0;
+        if constexpr (External::enabled) {
+          drift_x = -trap_delta * (x(k) - centre[0]);
+          drift_y = -trap_delta * (y(k) - centre[1]);
+          drift_z = -trap_delta * (z(k) - centre[2]) - sedimentation_delta;
+        }
+        if constexpr (Flow::enabled) {
+          drift_z += flow_delta \
+            * (1.0 - (x(k) * x(k) + y(k) * y(k)) * inverse_radius_squared);
+        }
+        x(k) = x(k) + vs_k[k] * ex(k) * delta \
+          + F[k] * x(k) * delta + xi_px * prefactor_xi_px;
+        y(k) = y(k) + vs_k[k] * ey(k) * delta \
+          + F[k] * y(k) * delta + xi_py * prefactor_xi_py;
+        z(k) = z(k) + vs_k[k] * ez(k) * delta \
+          + F[k] * z(k) * delta + xi_pz * prefactor_xi_pz;
+        if constexpr (Substeps::enabled) {
+          // zero but for the stiff particles
+          x(k) += correction_x[k];
+          y(k) += correction_y[k];
+          z(k) += correction_z[k];
+        }
+        if constexpr (External::enabled) {
+          x(k) += drift_x;
+          y(k) += drift_y;
+        }
+        if constexpr (External::enabled || Flow::enabled) {
+          z(k) += drift_z;
+        }
+      }
+    }
+  });
+}
+
+#endif  // SRC_HEADERS_UPDATE_POSITION_LAYOUT_H_
@@ -0,0 +1,60 @@
+#ifndef SRC_HEADERS_UPDATE_POSITION_SPHEROCYLINDER_H_
+#define SRC_HEADERS_UPDATE_POSITION_SPHEROCYLINDER_H_
+
+#include <iostream>
+#include <random>
+#include <cstring>
+#include <time.h>
+#include <stdio.h>
+#include <omp.h>
+#include <cmath>
+#include <algorithm>
+
+#include "cell_grid.h"
+#include "counter_rng.h"
+
+#define SPHEROCYLINDER_BATCH 64  // neighbours gathered per simd batch
+
+// Minimum distance between the segments r_i + lambda e_i and r_j + mu e_j,
+// |lambda|, |mu| <= half_length, with r_ij = r_j - r_i (Lumelsky).
+// Only clamps, no branch: the unconstrained lambda is clamped, mu follows
+// and is clamped, then lambda is recomputed from mu and clamped again.
+// Returns the squared distance and the closest points through lambda, mu.
+inline double segment_distance_squared(
+  double rx, double ry, double rz,
+  double eix, double eiy, double eiz,
+  double ejx, double ejy, double ejz,
+  double half_length, double &lambda, double &mu) {
+  double a = eix * rx + eiy * ry + eiz * rz;
+  double b = ejx * rx + ejy * ry + ejz * rz;
+  double c = eix * ejx + eiy * ejy + eiz * ejz;
+  double denominator = 1.0 - c * c;
+  // parallel segments: any lambda is a minimum, start from the middle
+  lambda = denominator > 1e-10 ? (a - c * b) / denominator : 0.0;
+  lambda = std::min(std::max(lambda, -half_length), half_length);
+  mu = std::min(std::max(c * lambda - b, -half_length), half_length);
+  lambda = std::min(std::max(a + c * mu, -half_length), half_length);
+  double dx = lambda * eix - mu * ejx - rx;
+  double dy = lambda * eiy - mu * ejy - ry;
+  double dz = lambda * eiz - mu * ejz - rz;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// Active spherocylinders (segment of length `length` along e, diameter L)
+// with WCA interactions on the minimum distance between the segments and
+// between the end caps and the cylinder walls. The forces give torques on
+// the orientation. `force` holds 6 * Particles values (force, torque).
+// Candidates are found in the grid, its cells must be at least
+// length + 2^(1/6) L wide. Noise from the counter-based generator of `seed`
+// at step `time`.
+void update_position_spherocylinder(
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, double *force,
+  int Particles, double delta, double vs,
+  double prefactor_e, double prefactor_xi_p,
+  double length, double epsilon, int L,
+  double Wall, double height,
+  cell_grid<3> &grid,
+  uint64_t seed, int time);
+
+#endif  // SRC_HEADERS_UPDATE_POSITION_SPHEROCYLINDER_H_
@@ -0,0 +1,23 @@
+#ifndef SRC_HEADERS_URING_WRITER_H_
+#define SRC_HEADERS_URING_WRITER_H_
+
+#include <stdio.h>
+#include <cstddef>
+
+// Sequential file writer submitting aligned buffers through io_uring on a
+// file opened with O_DIRECT (no page cache). A fixed pool of buffers is
+// registered with the ring, the caller only blocks when all of them are in
+// flight.
+struct uring_writer;
+
+// Returns NULL when io_uring or O_DIRECT is not available for `path`,
+// the caller then falls back to stdio.
+uring_writer *uring_writer_open(const char *path);
+
+void uring_writer_append(uring_writer *writer, const char *data, size_t size);
+
+// Waits for the writes in flight and truncates the padding of the last block.
+// Returns false when a write failed, the file is then incomplete.
+bool uring_writer_close(uring_writer *writer);
+
+#endif  // SRC_HEADERS_URING_WRITER_H_
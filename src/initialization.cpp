@@ -9,28 +9,71 @@ void initialization(
   default_random_engine &generator,
   uniform_real_distribution<double> &distribution,
   uniform_real_distribution<double> &distribution_e) {
-  double norm_e = 0.0, invers_norm_e = 0.0;
+  // counter-based draws from one seed, the result does not depend on the
+  // threads
+  uint64_t seed = (static_cast<uint64_t>(generator()) << 32) ^ generator();
+  double e_low = distribution_e.a(), e_range = distribution_e.b() - e_low;
+  double low = distribution.a(), range = distribution.b() - low;
+
   // Orientation
-#pragma omp parallel for simd
-  for (int k = 0; k < Particles; k++) {
-    ex[k] = distribution_e(generator);
-    ey[k] = distribution_e(generator);
-    ez[k] = distribution_e(generator);
+  parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+#pragma omp simd
+    for (int k = lo; k < hi; k++) {
+      ex[k] = e_low + e_range * counter_rng_uniform(seed, 0, k, 0);
+      ey[k] = e_low + e_range * counter_rng_uniform(seed, 0, k, 1);
+      ez[k] = e_low + e_range * counter_rng_uniform(seed, 0, k, 2);
 
-    // Need to normalize the orientaional vector
-    norm_e = sqrt(ex[k] * ex[k] + ey[k] * ey[k] + ez[k] * ez[k]);
-    invers_norm_e = 1.0 / norm_e;
+      // Need to normalize the orientaional vector
+      double norm_e = sqrt(ex[k] * ex[k] + ey[k] * ey[k] + ez[k] * ez[k]);
+      double invers_norm_e = 1.0 / norm_e;
 
-    ex[k] = ex[k] * invers_norm_e;
-    ey[k] = ey[k] * invers_norm_e;
-    ez[k] = ez[k] * invers_norm_e;
-  }
+      ex[k] = ex[k] * invers_norm_e;
+      ey[k] = ey[k] * invers_norm_e;
+      ez[k] = ez[k] * invers_norm_e;
+    }
+  });
 
   // Position
-#pragma omp parallel for simd
+  parallel_for(0, Particles, 1024, [&](int lo, int hi) {
+#pragma omp simd
+    for (int k = lo; k < hi; k++) {
+      x[k] = low + range * counter_rng_uniform(seed, 0, k, 3);
+      y[k] = low + range * counter_rng_uniform(seed, 0, k, 4);
+      z[k] = low + range * counter_rng_uniform(seed, 0, k, 5);
+    }
+  });
+}
+
+void initialization_2D(
+  double *x, double *y, double *theta,
+  int Particles, int L,
+  default_random_engine &generator,
+  uniform_real_distribution<double> &distribution) {
+  uniform_real_distribution<double> distribution_theta(0.0, 2.0 * M_PI);
+  // Orientation, angle on the circle
+  for (int k = 0; k < Particles; k++) {
+    theta[k] = distribution_theta(generator);
+  }
+
+  // Position in the disk, redrawn until no overlap with the particles
+  // already placed
+  double Wall_squared = distribution.b() * distribution.b();
   for (int k = 0; k < Particles; k++) {
-    x[k] = distribution(generator);
-    y[k] = distribution(generator);
-    z[k] = distribution(generator);
+    int count = 0;
+    bool overlap = true;
+    while (overlap) {
+      x[k] = distribution(generator);
+      y[k] = distribution(generator);
+      overlap = x[k] * x[k] + y[k] * y[k] > Wall_squared;
+      for (int j = 0; j < k && !overlap; j++) {
+        overlap = (x[j] - x[k]) * (x[j] - x[k]) \
+          + (y[j] - y[k]) * (y[j] - y[k]) < 1.5 * L * 1.5 * L;
+      }
+      count += 1;
+      if (count > 1000) {
+        printf("Number of particle too high\n");
+        exit(0);
+      }
+    }
   }
 }
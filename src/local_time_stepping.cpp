@@ -0,0 +1,39 @@
+#include <stdlib.h>
+#include <cstring>
+
+#include "headers/local_time_stepping.h"
+
+using namespace std;
+
+bool local_time_stepping_setup(
+  local_time_stepping &stepping, FILE *file, int Particles) {
+  if (file == NULL) {
+    return false;
+  }
+  fscanf(file, "%d\t%lf\t%lf\n", \
+    &stepping.substeps, &stepping.contact, &stepping.force);
+  printf("Local time stepping %d\t%lf\t%lf\n", \
+    stepping.substeps, stepping.contact, stepping.force);
+  stepping.x = reinterpret_cast<double*> \
+    (malloc(3 * Particles * sizeof(double)));
+  stepping.y = stepping.x + Particles;
+  stepping.z = stepping.y + Particles;
+  stepping.stiff = reinterpret_cast<char*>(malloc(Particles));
+  memset(stepping.stiff, 0, Particles);
+  stepping.substepped = 0;
+  return true;
+}
+
+void local_time_stepping_count(local_time_stepping &stepping, int Particles) {
+  long stiff = 0;
+#pragma omp parallel for reduction(+:stiff)
+  for (int k = 0; k < Particles; k++) {
+    stiff += stepping.stiff[k];
+  }
+  stepping.substepped += stiff;
+}
+
+void local_time_stepping_free(local_time_stepping &stepping) {
+  free(stepping.x);
+  free(stepping.stiff);
+}
@@ -0,0 +1,114 @@
+#include <cstring>
+#include <algorithm>
+
+#include "headers/neighbour_diagnostics.h"
+
+using namespace std;
+
+void neighbour_diagnostics_open(
+  neighbour_diagnostics &diagnostics, const char *path) {
+  memset(diagnostics.histogram_neighbours, 0, \
+    sizeof(diagnostics.histogram_neighbours));
+  memset(diagnostics.histogram_occupancy, 0, \
+    sizeof(diagnostics.histogram_occupancy));
+  diagnostics.candidates = 0;
+  diagnostics.pairs = 0;
+  diagnostics.lanes = 0;
+  diagnostics.samples = 0;
+  diagnostics.series = fopen(path, "w");
+  fprintf(diagnostics.series, "time,mean-neighbours,max-neighbours,"\
+    "mean-occupancy,max-occupancy,empty-cells,candidates-per-particle,"\
+    "pairs-in-cutoff-fraction,modelled-lane-utilisation,"\
+    "modelled-useful-lane-fraction\n");
+}
+
+void neighbour_diagnostics_record(
+  neighbour_diagnostics &diagnostics,
+  double *x, double *y, double *z, int Particles,
+  double cutoff, cell_grid<3> &grid, int time) {
+  double *position[3] = {x, y, z};
+  cell_grid_build(grid, position, Particles);
+  double cutoff_squared = cutoff * cutoff;
+  int cells = static_cast<int>(grid.cell_start.size()) - 1;
+
+  long neighbours_histogram[DIAGNOSTICS_BINS] = {0};
+  long occupancy_histogram[DIAGNOSTICS_BINS] = {0};
+  long candidates = 0, pairs = 0, lanes = 0;
+  int max_neighbours = 0, max_occupancy = 0, empty = 0;
+
+#pragma omp parallel for schedule(dynamic, 64) \
+  reduction(+:neighbours_histogram[:DIAGNOSTICS_BINS], candidates, pairs, \
+    lanes) reduction(max:max_neighbours)
+  for (int k = 0; k < Particles; k++) {
+    int neighbours = 0;
+    cell_grid_for_each_neighbour_cell(grid, k, [&](int begin, int end) {
+      int n = end - begin;
+      lanes += (n + DIAGNOSTICS_LANES - 1) / DIAGNOSTICS_LANES \
+        * DIAGNOSTICS_LANES;
+      for (int i = begin; i < end; i++) {
+        int j = grid.particles[i];
+        if (j == k) {
+          continue;
+        }
+        candidates += 1;
+        double R2 = (x[j] - x[k]) * (x[j] - x[k]) \
+          + (y[j] - y[k]) * (y[j] - y[k]) \
+          + (z[j] - z[k]) * (z[j] - z[k]);
+        neighbours += R2 < cutoff_squared;
+      }
+    });
+    pairs += neighbours;
+    max_neighbours = max(max_neighbours, neighbours);
+    neighbours_histogram[min(neighbours, DIAGNOSTICS_BINS - 1)] += 1;
+  }
+
+#pragma omp parallel for \
+  reduction(+:occupancy_histogram[:DIAGNOSTICS_BINS], empty) \
+  reduction(max:max_occupancy)
+  for (int c = 0; c < cells; c++) {
+    int occupancy = grid.cell_start[c + 1] - grid.cell_start[c];
+    occupancy_histogram[min(occupancy, DIAGNOSTICS_BINS - 1)] += 1;
+    max_occupancy = max(max_occupancy, occupancy);
+    empty += occupancy == 0;
+  }
+
+  for (int b = 0; b < DIAGNOSTICS_BINS; b++) {
+    diagnostics.histogram_neighbours[b] += neighbours_histogram[b];
+    diagnostics.histogram_occupancy[b] += occupancy_histogram[b];
+  }
+  diagnostics.candidates += candidates;
+  diagnostics.pairs += pairs;
+  diagnostics.lanes += lanes;
+  diagnostics.samples += 1;
+
+  fprintf(diagnostics.series, "%d,%lf,%d,%lf,%d,%lf,%lf,%lf,%lf,%lf\n", \
+    time, static_cast<double>(pairs) / Particles, max_neighbours, \
+    static_cast<double>(Particles) / cells, max_occupancy, \
+    static_cast<double>(empty) / cells, \
+    static_cast<double>(candidates) / Particles, \
+    candidates > 0 ? static_cast<double>(pairs) / candidates : 0.0, \
+    lanes > 0 ? static_cast<double>(candidates) / lanes : 0.0, \
+    lanes > 0 ? static_cast<double>(pairs) / lanes : 0.0);
+}
+
+void neighbour_diagnostics_close(
+  neighbour_diagnostics &diagnostics, const char *path) {
+  FILE *histogram = fopen(path, "w");
+  fprintf(histogram, "n,particles-with-n-neighbours,cells-with-n-particles\n");
+  for (int b = 0; b < DIAGNOSTICS_BINS; b++) {
+    fprintf(histogram, "%d,%ld,%ld\n", b, \
+      diagnostics.histogram_neighbours[b], diagnostics.histogram_occupancy[b]);
+  }
+  fclose(histogram);
+  fclose(diagnostics.series);
+
+  if (diagnostics.candidates > 0) {
+    printf("\nPairs inside the cutoff %lf of the candidates, "\
+      "modelled lane utilisation %lf (useful %lf, %d lanes, the pair "\
+      "loop is scalar)", \
+      static_cast<double>(diagnostics.pairs) / diagnostics.candidates, \
+      static_cast<double>(diagnostics.candidates) / diagnostics.lanes, \
+      static_cast<double>(diagnostics.pairs) / diagnostics.lanes, \
+      DIAGNOSTICS_LANES);
+  }
+}
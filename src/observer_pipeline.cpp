@@ -0,0 +1,155 @@
+#include <omp.h>
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+
+#include "headers/observer_pipeline.h"
+
+using namespace std;
+
+void observer_add(
+  observer_pipeline &pipeline, const char *name, int every,
+  observer_function run, void *context) {
+  observer added = {name, every, run, context, false, 0, 0, 0, 0.0};
+  pipeline.observers.push_back(added);
+}
+
+// Drops a handle of a job, with the pipeline locked
+static void observer_release(
+  observer_pipeline &pipeline, observer_job &job) {
+  if (job.snapshot.use_count() == 1) {
+    pipeline.snapshots--;
+  }
+  job.snapshot.reset();
+}
+
+static void observer_worker(observer_pipeline *pipeline) {
+  omp_set_num_threads(1);  // the analyses stay on their spare thread
+  unique_lock<mutex> guard(pipeline->lock);
+  for (;;) {
+    // oldest sample of an observer that is not already running
+    auto next = find_if(
+      pipeline->queue.begin(), pipeline->queue.end(),
+      [pipeline](const observer_job &job) {
+        return !pipeline->observers[job.observer].running;
+      });
+    if (next == pipeline->queue.end()) {
+      if (pipeline->stop && pipeline->queue.empty()) {
+        return;
+      }
+      pipeline->ready.wait(guard);
+      continue;
+    }
+    observer_job job = *next;
+    pipeline->queue.erase(next);
+    observer &o = pipeline->observers[job.observer];
+    if (pipeline->staleness > 0 && !pipeline->stop \
+      && pipeline->time - job.snapshot->time > pipeline->staleness) {
+      o.stale++;
+      observer_release(*pipeline, job);
+      continue;
+    }
+
+    o.running = true;
+    guard.unlock();
+    double start = omp_get_wtime();
+    o.run(o.context, *job.snapshot);
+    double seconds = omp_get_wtime() - start;
+    guard.lock();
+    o.running = false;
+    o.completed++;
+    o.seconds += seconds;
+    observer_release(*pipeline, job);
+    pipeline->ready.notify_all();
+  }
+}
+
+void observer_pipeline_start(
+  observer_pipeline &pipeline, int threads, int budget, int staleness) {
+  pipeline.budget = max(1, budget);
+  pipeline.staleness = staleness;
+  pipeline.snapshots = 0;
+  pipeline.time = 0;
+  pipeline.stop = false;
+  for (int t = 0; t < threads; t++) {
+    pipeline.threads.push_back(thread(observer_worker, &pipeline));
+  }
+}
+
+void observer_pipeline_step(
+  observer_pipeline &pipeline,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time) {
+  pipeline.time = time;
+  int observers = static_cast<int>(pipeline.observers.size());
+
+  if (pipeline.threads.empty()) {
+    // synchronous: a view of the live arrays
+    observer_snapshot view = {time, Particles, x, y, z, ex, ey, ez, {}};
+    for (observer &o : pipeline.observers) {
+      if (o.every > 0 && time % o.every == 0) {
+        double start = omp_get_wtime();
+        o.run(o.context, view);
+        o.seconds += omp_get_wtime() - start;
+        o.completed++;
+      }
+    }
+    return;
+  }
+
+  vector<int> due;
+  {
+    lock_guard<mutex> guard(pipeline.lock);
+    for (int i = 0; i < observers; i++) {
+      const observer &o = pipeline.observers[i];
+      if (o.every > 0 && time % o.every == 0) {
+        due.push_back(i);
+      }
+    }
+    if (due.empty()) {
+      return;
+    }
+    if (pipeline.snapshots >= pipeline.budget) {
+      for (int i : due) {
+        pipeline.observers[i].dropped++;
+      }
+      return;
+    }
+    pipeline.snapshots++;  // reserved while the copy is made
+  }
+
+  shared_ptr<observer_snapshot> snapshot = make_shared<observer_snapshot>();
+  snapshot->time = time;
+  snapshot->Particles = Particles;
+  snapshot->data.resize(6 * static_cast<size_t>(Particles));
+  double *source[6] = {x, y, z, ex, ey, ez};
+  double **component[6] = {&snapshot->x, &snapshot->y, &snapshot->z,
+    &snapshot->ex, &snapshot->ey, &snapshot->ez};
+  for (int c = 0; c < 6; c++) {
+    *component[c] = snapshot->data.data() + static_cast<size_t>(c) * Particles;
+    memcpy(*component[c], source[c], Particles * sizeof(double));
+  }
+
+  lock_guard<mutex> guard(pipeline.lock);
+  for (int i : due) {
+    pipeline.queue.push_back({i, snapshot});
+  }
+  snapshot.reset();  // the jobs hold it now, counted by observer_release
+  pipeline.ready.notify_all();
+}
+
+void observer_pipeline_stop(observer_pipeline &pipeline) {
+  {
+    lock_guard<mutex> guard(pipeline.lock);
+    pipeline.stop = true;
+  }
+  pipeline.ready.notify_all();
+  for (thread &t : pipeline.threads) {
+    t.join();
+  }
+  pipeline.threads.clear();
+  for (const observer &o : pipeline.observers) {
+    printf("\nObserver %s: %ld samples (%f s), %ld dropped, %ld stale", \
+      o.name, o.completed, o.seconds, o.dropped, o.stale);
+  }
+}
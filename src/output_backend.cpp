@@ -0,0 +1,53 @@
+#include "headers/output_backend.h"
+#include "headers/print_file.h"
+
+using namespace std;
+
+void output_backend_open(
+  output_backend &output, const char *path, bool use_uring) {
+  output.datacsv = NULL;
+  output.uring = NULL;
+  if (use_uring) {
+    output.uring = uring_writer_open(path);
+    if (output.uring == NULL) {
+      printf("io_uring output not available, using stdio.\n");
+    }
+  }
+  if (output.uring == NULL) {
+    output.datacsv = fopen(path, "w");
+  }
+}
+
+void output_backend_print(output_backend &output, const char *text) {
+  if (output.uring != NULL) {
+    uring_writer_append(output.uring, text, strlen(text));
+  } else {
+    fputs(text, output.datacsv);
+  }
+}
+
+void output_backend_frame(
+  output_backend &output,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time) {
+  if (output.uring == NULL) {
+    print_file(x, y, z, ex, ey, ez, Particles, time, output.datacsv);
+    return;
+  }
+  // same format as print_file
+  char line[256];
+  for (int k = 0; k < Particles; k++) {
+    int size = snprintf(line, sizeof(line), \
+      "Particles%d,%lf,%lf,%lf,%lf,%lf,%lf,%d\n", \
+      k, x[k], y[k], z[k], ex[k], ey[k], ez[k], time);
+    uring_writer_append(output.uring, line, size);
+  }
+}
+
+bool output_backend_close(output_backend &output) {
+  if (output.uring != NULL) {
+    return uring_writer_close(output.uring);
+  }
+  bool ok = ferror(output.datacsv) == 0;
+  return fclose(output.datacsv) == 0 && ok;
+}
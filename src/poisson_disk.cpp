@@ -0,0 +1,116 @@
+#include <stdint.h>
+#include <cstdlib>
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "headers/poisson_disk.h"
+#include "headers/counter_rng.h"
+#include "headers/thread_pool.h"
+
+using namespace std;
+
+void poisson_disk_positions(
+  double *x, double *y, double *z, int Particles,
+  double Wall, double height, int L,
+  default_random_engine &generator) {
+  if (Particles <= 0) {
+    return;
+  }
+  uint64_t seed = (static_cast<uint64_t>(generator()) << 32) ^ generator();
+  double r_squared = 1.5 * L * 1.5 * L;
+  double side = 1.5 * L / sqrt(3.0);
+  double rho_max = Wall - 0.5 * L, z_max = height - 0.5 * L;
+  double lower[3] = {-rho_max, -rho_max, -z_max};
+  long n[3];
+  n[0] = n[1] = max(1L, static_cast<long>(ceil(2.0 * rho_max / side)));
+  n[2] = max(1L, static_cast<long>(ceil(2.0 * z_max / side)));
+  long cells = n[0] * n[1] * n[2];
+
+  vector<unsigned char> filled(cells, 0);
+  vector<double> sample(3 * cells);
+  long placed = 0;
+  for (int round = 0; round < POISSON_DISK_ROUNDS && placed < Particles; \
+    round++) {
+    for (int phase = 0; phase < 27; phase++) {
+      long p[3] = {phase % 3, phase / 3 % 3, phase / 9}, m[3];
+      for (int d = 0; d < 3; d++) {
+        m[d] = (n[d] - p[d] + 2) / 3;
+      }
+      atomic<long> accepted(0);
+      parallel_for(0, static_cast<int>(m[0] * m[1] * m[2]), 256, [&](
+        int lo, int hi) {
+        long count = 0;
+        for (int t = lo; t < hi; t++) {
+          long c[3] = {p[0] + 3 * (t % m[0]), p[1] + 3 * (t / m[0] % m[1]),
+            p[2] + 3 * (t / (m[0] * m[1]))};
+          long cell = c[0] + n[0] * (c[1] + n[1] * c[2]);
+          if (filled[cell]) {
+            continue;
+          }
+          double dart[3];
+          for (int d = 0; d < 3; d++) {
+            dart[d] = lower[d] + side * (c[d] \
+              + counter_rng_uniform(seed, round, cell, d));
+          }
+          if (dart[0] * dart[0] + dart[1] * dart[1] > rho_max * rho_max \
+            || abs(dart[2]) > z_max) {
+            continue;
+          }
+          // samples of the cells at most 2 away, none of the same phase
+          bool overlap = false;
+          for (long k = max(c[2] - 2, 0L); \
+            k <= min(c[2] + 2, n[2] - 1) && !overlap; k++) {
+            for (long j = max(c[1] - 2, 0L); \
+              j <= min(c[1] + 2, n[1] - 1) && !overlap; j++) {
+              for (long i = max(c[0] - 2, 0L); \
+                i <= min(c[0] + 2, n[0] - 1) && !overlap; i++) {
+                long other = i + n[0] * (j + n[1] * k);
+                if (filled[other]) {
+                  double dx = sample[3 * other] - dart[0];
+                  double dy = sample[3 * other + 1] - dart[1];
+                  double dz = sample[3 * other + 2] - dart[2];
+                  overlap = dx * dx + dy * dy + dz * dz < r_squared;
+                }
+              }
+            }
+          }
+          if (!overlap) {
+            copy(dart, dart + 3, sample.begin() + 3 * cell);
+            filled[cell] = 1;
+            count++;
+          }
+        }
+        accepted += count;
+      });
+      placed += accepted;
+    }
+  }
+  if (placed < Particles) {
+    printf("Number of particle too high\n");
+    exit(0);
+  }
+
+  // Particles of the samples, those of the smallest random keys
+  vector<pair<uint64_t, long>> keys;
+  keys.reserve(placed);
+  for (long cell = 0; cell < cells; cell++) {
+    if (filled[cell]) {
+      keys.push_back({counter_rng_bits(seed, POISSON_DISK_ROUNDS, cell, 0), \
+        cell});
+    }
+  }
+  nth_element(keys.begin(), keys.begin() + (Particles - 1), keys.end());
+  keys.resize(Particles);
+  sort(keys.begin(), keys.end(), [](
+    const pair<uint64_t, long> &a, const pair<uint64_t, long> &b) {
+    return a.second < b.second;
+  });
+  for (int k = 0; k < Particles; k++) {
+    long cell = keys[k].second;
+    x[k] = sample[3 * cell];
+    y[k] = sample[3 * cell + 1];
+    z[k] = sample[3 * cell + 2];
+  }
+}
@@ -11,3 +11,13 @@ void print_file(
       k, x[k], y[k], z[k], ex[k], ey[k], ez[k], time);
   }
 }
+
+void print_file_2D(
+  double *x, double *y, double *theta,
+  int Particles, int time,
+  FILE *datacsv) {
+  for (int k = 0; k < Particles; k++) {
+    fprintf(datacsv, "Particles%d,%lf,%lf,%lf,%lf,%d\n", \
+      k, x[k], y[k], cos(theta[k]), sin(theta[k]), time);
+  }
+}
@@ -0,0 +1,273 @@
+#include <sys/stat.h>
+#include <stdio.h>
+#include <cstring>
+
+#include "headers/checkpoint.h"
+#include "headers/result_cache.h"
+
+using namespace std;
+
+#define RESULT_CACHE_OFFSET 0xCBF29CE484222325ULL
+
+uint64_t result_cache_hash(const void *data, size_t size, uint64_t hash) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+// Hash of a whole file, false if it does not exist
+static bool result_cache_hash_file(const char *path, uint64_t &hash) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  hash = RESULT_CACHE_OFFSET;
+  char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    hash = result_cache_hash(buffer, n, hash);
+  }
+  fclose(file);
+  return true;
+}
+
+// Copies `from` into `to`, without its first line if `skip_header`, at the
+// end of `to` if `append`, false if anything could not be written
+static bool result_cache_copy(
+  const char *from, const char *to, bool append, bool skip_header) {
+  FILE *in = fopen(from, "rb");
+  if (in == NULL) {
+    return false;
+  }
+  FILE *out = fopen(to, append ? "ab" : "wb");
+  if (out == NULL) {
+    fclose(in);
+    return false;
+  }
+  if (skip_header) {
+    int c;
+    while ((c = fgetc(in)) != EOF && c != '\n') {
+    }
+  }
+  char buffer[65536];
+  size_t n;
+  bool ok = true;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+    ok = ok && fwrite(buffer, 1, n, out) == n;
+  }
+  ok = ok && !ferror(in);
+  fclose(in);
+  ok = (fclose(out) == 0) && ok;
+  return ok;
+}
+
+// Writes into `out` the histogram `to` (label,count,count lines under
+// a header) with the counts of `from` added, bin by bin
+static bool result_cache_add_counts(
+  const char *from, const char *to, const char *out) {
+  FILE *in = fopen(from, "r");
+  if (in == NULL) {
+    return false;
+  }
+  FILE *entry = fopen(to, "r");
+  if (entry == NULL) {
+    fclose(in);
+    return false;
+  }
+  string sum;
+  char line_in[256], line_out[256], label[64];
+  long a_in, b_in, a_out, b_out;
+  bool header = true;
+  while (fgets(line_in, sizeof(line_in), in) != NULL \
+    && fgets(line_out, sizeof(line_out), entry) != NULL) {
+    if (!header \
+      && sscanf(line_in, "%63[^,],%ld,%ld", label, &a_in, &b_in) == 3 \
+      && sscanf(line_out, "%*[^,],%ld,%ld", &a_out, &b_out) == 2) {
+      snprintf(line_out, sizeof(line_out), "%s,%ld,%ld\n", label, \
+        a_in + a_out, b_in + b_out);
+    }
+    sum += line_out;
+    header = false;
+  }
+  fclose(in);
+  fclose(entry);
+
+  FILE *file = fopen(out, "w");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = fputs(sum.c_str(), file) >= 0;
+  return (fclose(file) == 0) && ok;
+}
+
+// Writes `text` into `path`
+static bool result_cache_write(const string &path, const string &text) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = fputs(text.c_str(), file) >= 0;
+  return (fclose(file) == 0) && ok;
+}
+
+bool result_cache_open(
+  result_cache &cache, const char *root, const run_options &options,
+  int &steps) {
+  FILE *parameter = fopen("parameter.txt", "r");
+  if (parameter == NULL) {
+    return false;
+  }
+  double value[8];
+  fscanf(parameter, "%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf\t%d\n", \
+    &value[0], &value[1], &value[2], &value[3], &value[4], &value[5], \
+    &value[6], &value[7], &steps);
+  fclose(parameter);
+
+  char line[256];
+  uint64_t build = 0;
+  result_cache_hash_file("/proc/self/exe", build);
+  snprintf(line, sizeof(line), "build %016llx\n", \
+    static_cast<unsigned long long>(build));
+  cache.configuration = line;
+  cache.configuration += "parameters";
+  for (int i = 0; i < 8; i++) {
+    snprintf(line, sizeof(line), " %.17g", value[i]);
+    cache.configuration += line;
+  }
+  snprintf(line, sizeof(line), "\nseed %llu\noutput_every %d\n"\
+    "bond_order %d\ndiagnostics %d\n", \
+    static_cast<unsigned long long>(options.seed), options.output_every, \
+    options.bond_order_every, options.diagnostics_every);
+  cache.configuration += line;
+  const char *inputs[] = {"spherocylinder.txt", "chemical_field.txt",
+    "quorum_sensing.txt", "polymer.txt", "external_field.txt",
+    "poiseuille_flow.txt", "local_time_stepping.txt"};
+  for (const char *input : inputs) {
+    uint64_t hash;
+    if (result_cache_hash_file(input, hash)) {
+      snprintf(line, sizeof(line), "%s %016llx\n", input, \
+        static_cast<unsigned long long>(hash));
+      cache.configuration += line;
+    }
+  }
+
+  uint64_t key = result_cache_hash(
+    cache.configuration.data(), cache.configuration.size(),
+    RESULT_CACHE_OFFSET);
+  snprintf(line, sizeof(line), "%s/%016llx", root, \
+    static_cast<unsigned long long>(key));
+  cache.directory = line;
+  mkdir(root, 0755);
+  mkdir(cache.directory.c_str(), 0755);
+
+  cache.files.assign(1, "simulation.csv");
+  cache.series.assign(1, true);
+  if (options.bond_order_every > 0) {
+    cache.files.insert(cache.files.end(), \
+      {"bond_order.csv", "bond_order_histogram.csv"});
+    cache.series.insert(cache.series.end(), {true, false});
+  }
+  if (options.diagnostics_every > 0) {
+    cache.files.insert(cache.files.end(), \
+      {"diagnostics.csv", "diagnostics_histogram.csv"});
+    cache.series.insert(cache.series.end(), {true, false});
+  }
+
+  cache.steps = 0;
+  FILE *entry = fopen((cache.directory + "/steps.txt").c_str(), "r");
+  if (entry != NULL) {
+    if (fscanf(entry, "%d", &cache.steps) != 1) {
+      cache.steps = 0;
+    }
+    fclose(entry);
+  }
+
+  // the checkpoint must be the final state of the entry to extend it
+  FILE *chemical = fopen("chemical_field.txt", "r");
+  int checkpoint_step = -1;
+  cache.extendable = chemical == NULL \
+    && checkpoint_time(result_cache_checkpoint(cache).c_str(), \
+      checkpoint_step) \
+    && checkpoint_step == cache.steps;
+  if (chemical != NULL) {
+    fclose(chemical);
+  }
+  return true;
+}
+
+void result_cache_restore(const result_cache &cache) {
+  for (const string &file : cache.files) {
+    result_cache_copy(
+      (cache.directory + "/" + file).c_str(), ("./data/" + file).c_str(),
+      false, false);
+  }
+}
+
+string result_cache_checkpoint(const result_cache &cache) {
+  return cache.directory + "/checkpoint.bin";
+}
+
+bool result_cache_store(
+  result_cache &cache, int steps,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, uint64_t seed, const double *field, size_t field_values) {
+  // every file of the entry is staged next to it first
+  bool ok = true;
+  vector<string> staged;
+  for (size_t i = 0; i < cache.files.size() && ok; i++) {
+    string data = "./data/" + cache.files[i];
+    string cached = cache.directory + "/" + cache.files[i];
+    staged.push_back(cached + ".tmp");
+    if (cache.steps > 0 && cache.series[i]) {
+      // the entry followed by the samples of the extension
+      ok = result_cache_copy(
+        cached.c_str(), staged.back().c_str(), false, false) \
+        && result_cache_copy(data.c_str(), staged.back().c_str(), true, true);
+    } else if (cache.steps > 0) {
+      // histograms: the samples of the entry and of the extension
+      ok = result_cache_add_counts(
+        data.c_str(), cached.c_str(), staged.back().c_str());
+    } else {
+      ok = result_cache_copy(
+        data.c_str(), staged.back().c_str(), false, false);
+    }
+    // ./data holds the whole run as well
+    ok = ok && (cache.steps == 0 || result_cache_copy(
+      staged.back().c_str(), data.c_str(), false, false));
+  }
+  string checkpoint = result_cache_checkpoint(cache);
+  ok = ok && checkpoint_write(
+    (checkpoint + ".tmp").c_str(), x, y, z, ex, ey, ez, Particles, steps,
+    seed, field, field_values);
+  string configuration = cache.directory + "/configuration.txt";
+  ok = ok && result_cache_write(configuration + ".tmp", cache.configuration);
+  if (!ok) {
+    for (const string &file : staged) {
+      remove(file.c_str());
+    }
+    remove((checkpoint + ".tmp").c_str());
+    remove((configuration + ".tmp").c_str());
+    return false;
+  }
+
+  // without steps.txt the entry is empty until all the files are in place
+  string entry = cache.directory + "/steps.txt";
+  remove(entry.c_str());
+  for (size_t i = 0; i < staged.size(); i++) {
+    ok = ok && rename(staged[i].c_str(), \
+      (cache.directory + "/" + cache.files[i]).c_str()) == 0;
+  }
+  ok = ok && rename((checkpoint + ".tmp").c_str(), checkpoint.c_str()) == 0;
+  ok = ok \
+    && rename((configuration + ".tmp").c_str(), configuration.c_str()) == 0;
+  char text[32];
+  snprintf(text, sizeof(text), "%d\n", steps);
+  ok = ok && result_cache_write(entry + ".tmp", text) \
+    && rename((entry + ".tmp").c_str(), entry.c_str()) == 0;
+  if (ok) {
+    cache.steps = steps;
+  }
+  return ok;
+}
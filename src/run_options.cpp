@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "headers/run_options.h"
+
+using namespace std;
+
+bool parse_run_options(int argc, char *argv[], run_options &options) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--output=stdio") == 0) {
+      options.uring_output = false;
+    } else if (strcmp(argv[i], "--output=uring") == 0) {
+      options.uring_output = true;
+    } else if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+      options.checkpoint_every = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--checkpoint-children=", 22) == 0) {
+      options.checkpoint_children = max(1, atoi(argv[i] + 22));
+    } else if (strncmp(argv[i], "--restart=", 10) == 0) {
+      options.restart = argv[i] + 10;
+    } else if (strncmp(argv[i], "--bond-order=", 13) == 0) {
+      options.bond_order_every = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--diagnostics=", 14) == 0) {
+      options.diagnostics_every = atoi(argv[i] + 14);
+    } else if (strncmp(argv[i], "--output-every=", 15) == 0) {
+      options.output_every = atoi(argv[i] + 15);
+    } else if (strncmp(argv[i], "--trajectory=", 13) == 0) {
+      options.trajectory_every = atoi(argv[i] + 13);
+    } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+      options.seed = strtoull(argv[i] + 7, NULL, 10);
+    } else if (strncmp(argv[i], "--steer=", 8) == 0) {
+      options.steer = argv[i] + 8;
+    } else if (strncmp(argv[i], "--replay=", 9) == 0) {
+      options.replay = argv[i] + 9;
+    } else if (strncmp(argv[i], "--window=", 9) == 0) {
+      sscanf(argv[i] + 9, "%d,%d", &options.window_begin, &options.window_end);
+    } else if (strncmp(argv[i], "--observers=", 12) == 0) {
+      options.observer_threads = max(0, atoi(argv[i] + 12));
+    } else if (strncmp(argv[i], "--observer-budget=", 18) == 0) {
+      options.observer_budget = max(1, atoi(argv[i] + 18));
+    } else if (strncmp(argv[i], "--observer-staleness=", 21) == 0) {
+      options.observer_staleness = max(0, atoi(argv[i] + 21));
+    } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+      options.cache = argv[i] + 8;
+    } else if (strncmp(argv[i], "--flight-recorder=", 18) == 0) {
+      options.flight_frames = max(0, atoi(argv[i] + 18));
+    } else if (strncmp(argv[i], "--flight-cluster=", 17) == 0) {
+      options.flight_cluster = max(0, atoi(argv[i] + 17));
+    } else {
+      printf("unknown option %s\n", argv[i]);
+      printf("usage: %s [--output=stdio|uring] [--checkpoint=<steps>] "\
+        "[--checkpoint-children=<n>] [--restart=<checkpoint>] "\
+        "[--bond-order=<steps>] [--diagnostics=<steps>] "\
+        "[--output-every=<steps>] [--trajectory=<steps>] [--seed=<n>] "\
+        "[--steer=<socket>] [--observers=<threads>] "\
+        "[--observer-budget=<snapshots>] [--observer-staleness=<steps>] "\
+        "[--cache=<directory>] [--flight-recorder=<frames>] "\
+        "[--flight-cluster=<particles>] "\
+        "[--replay=<checkpoint> --window=<t0>,<t1>]\n", argv[0]);
+      return false;
+    }
+  }
+  if (options.cache != NULL && (options.seed == 0 || options.restart != NULL \
+    || options.replay != NULL || options.steer != NULL \
+    || options.trajectory_every > 0 || options.observer_threads > 0 \
+    || options.flight_frames > 0)) {
+    // the outputs would not be a function of the configuration
+    printf("--cache needs --seed, without --restart, --replay, --steer, "\
+      "--trajectory, --observers and --flight-recorder\n");
+    return false;
+  }
+  if (options.replay != NULL && options.window_end < options.window_begin) {
+    printf("--replay needs --window=<t0>,<t1> with t0 <= t1\n");
+    return false;
+  }
+  return true;
+}
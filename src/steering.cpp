@@ -0,0 +1,141 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "headers/steering.h"
+
+using namespace std;
+
+bool steering_open(steering_server &server, const char *path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    return false;
+  }
+  snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+
+  server.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (server.listen_fd < 0) {
+    return false;
+  }
+  unlink(path);  // socket left by a previous run
+  if (bind(server.listen_fd, reinterpret_cast<sockaddr*>(&address), \
+    sizeof(address)) != 0 || listen(server.listen_fd, 4) != 0) {
+    close(server.listen_fd);
+    return false;
+  }
+  server.path = path;
+  return true;
+}
+
+static void steering_reply(int fd, const char *text) {
+  // short replies, a full socket buffer drops them instead of blocking
+  send(fd, text, strlen(text), MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+// Observables of the current state, only computed when asked for
+static void steering_observables(
+  char *reply, size_t size, const steering_parameters &parameters,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, double Wall, int L, int time) {
+  double px = 0.0, py = 0.0, pz = 0.0, mean_z = 0.0, mean_rho = 0.0;
+  int wall = 0;
+  double inner_squared = (Wall - 2.0 * L) * (Wall - 2.0 * L);
+#pragma omp parallel for reduction(+:px, py, pz, mean_z, mean_rho, wall)
+  for (int k = 0; k < Particles; k++) {
+    px += ex[k];
+    py += ey[k];
+    pz += ez[k];
+    mean_z += z[k];
+    double rho_squared = x[k] * x[k] + y[k] * y[k];
+    mean_rho += sqrt(rho_squared);
+    wall += rho_squared > inner_squared;
+  }
+  snprintf(reply, size, "time=%d vs=%g De=%g epsilon=%g output_every=%d "\
+    "polarisation=%g mean_ez=%g mean_z=%g mean_rho=%g wall_fraction=%g\n", \
+    time, parameters.vs, parameters.De, parameters.epsilon, \
+    parameters.output_every, \
+    sqrt(px * px + py * py + pz * pz) / Particles, pz / Particles, \
+    mean_z / Particles, mean_rho / Particles, \
+    static_cast<double>(wall) / Particles);
+}
+
+bool steering_poll(
+  steering_server &server, steering_parameters &parameters,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, double Wall, int L, int time) {
+  int fd;
+  while (static_cast<int>(server.clients.size()) < STEERING_MAX_CLIENTS \
+    && (fd = accept4(server.listen_fd, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+    server.clients.push_back(fd);
+    server.input.push_back(string());
+  }
+
+  bool changed = false;
+  char buffer[1024], reply[512];
+  for (size_t c = 0; c < server.clients.size();) {
+    ssize_t n;
+    while ((n = recv(server.clients[c], buffer, sizeof(buffer), 0)) > 0) {
+      server.input[c].append(buffer, n);
+    }
+    bool closed = n == 0 \
+      || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+
+    size_t end;
+    while ((end = server.input[c].find('\n')) != string::npos) {
+      string line = server.input[c].substr(0, end);
+      server.input[c].erase(0, end + 1);
+      char command[16] = "", name[32] = "";
+      double value = 0.0;
+      int fields = sscanf(line.c_str(), "%15s %31s %lf", \
+        command, name, &value);
+      if (fields >= 1 && strcmp(command, "get") == 0) {
+        steering_observables(
+          reply, sizeof(reply), parameters, x, y, z, ex, ey, ez,
+          Particles, Wall, L, time);
+      } else if (fields == 3 && strcmp(command, "set") == 0) {
+        snprintf(reply, sizeof(reply), "ok\n");
+        if (strcmp(name, "vs") == 0) {
+          parameters.vs = value;
+        } else if (strcmp(name, "De") == 0 && value >= 0.0) {
+          parameters.De = value;
+        } else if (strcmp(name, "epsilon") == 0) {
+          parameters.epsilon = value;
+        } else if (strcmp(name, "output_every") == 0 && value >= 0.0) {
+          parameters.output_every = static_cast<int>(value);
+        } else {
+          snprintf(reply, sizeof(reply), "error: cannot set %s\n", name);
+        }
+        changed = changed || reply[0] == 'o';
+      } else {
+        snprintf(reply, sizeof(reply), "error: set <vs|De|epsilon|"\
+          "output_every> <value> or get\n");
+      }
+      steering_reply(server.clients[c], reply);
+    }
+
+    if (closed) {
+      close(server.clients[c]);
+      server.clients.erase(server.clients.begin() + c);
+      server.input.erase(server.input.begin() + c);
+    } else {
+      c++;
+    }
+  }
+  return changed;
+}
+
+void steering_close(steering_server &server) {
+  for (int fd : server.clients) {
+    close(fd);
+  }
+  close(server.listen_fd);
+  unlink(server.path.c_str());
+}
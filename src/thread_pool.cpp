@@ -0,0 +1,214 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "headers/thread_pool.h"
+
+#define THREAD_POOL_DEQUE 64    // ranges per deque, > log2(range / grain)
+#define THREAD_POOL_SPIN 20000  // polls for a new job before sleeping
+
+using namespace std;
+
+// Chase-Lev deque of ranges (Le et al., PPoPP 2013). A range is packed in
+// 64 bits so that a slot is a single atomic. The owner pushes and takes at
+// the bottom, the thieves steal at the top. Its size is fixed: a worker
+// only holds the halves of the range it is splitting.
+struct thread_pool_deque {
+  alignas(64) atomic<int64_t> top;
+  alignas(64) atomic<int64_t> bottom;
+  atomic<uint64_t> ranges[THREAD_POOL_DEQUE];
+};
+
+static inline uint64_t range_pack(int lo, int hi) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(lo)) << 32) \
+    | static_cast<uint32_t>(hi);
+}
+
+static inline void range_unpack(uint64_t range, int &lo, int &hi) {
+  lo = static_cast<int>(static_cast<uint32_t>(range >> 32));
+  hi = static_cast<int>(static_cast<uint32_t>(range));
+}
+
+static void deque_push(thread_pool_deque &deque, uint64_t range) {
+  int64_t b = deque.bottom.load(memory_order_relaxed);
+  deque.ranges[b & (THREAD_POOL_DEQUE - 1)].store(
+    range, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  deque.bottom.store(b + 1, memory_order_relaxed);
+}
+
+static bool deque_take(thread_pool_deque &deque, uint64_t &range) {
+  int64_t b = deque.bottom.load(memory_order_relaxed) - 1;
+  deque.bottom.store(b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = deque.top.load(memory_order_relaxed);
+  if (t > b) {
+    deque.bottom.store(b + 1, memory_order_relaxed);
+    return false;
+  }
+  range = deque.ranges[b & (THREAD_POOL_DEQUE - 1)].load(
+    memory_order_relaxed);
+  if (t < b) {
+    return true;
+  }
+  // last range, raced with the thieves
+  bool won = deque.top.compare_exchange_strong(
+    t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+  deque.bottom.store(b + 1, memory_order_relaxed);
+  return won;
+}
+
+static bool deque_steal(thread_pool_deque &deque, uint64_t &range) {
+  int64_t t = deque.top.load(memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = deque.bottom.load(memory_order_acquire);
+  if (t >= b) {
+    return false;
+  }
+  range = deque.ranges[t & (THREAD_POOL_DEQUE - 1)].load(
+    memory_order_relaxed);
+  return deque.top.compare_exchange_strong(
+    t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+struct thread_pool {
+  int threads;  // workers, the thread calling thread_pool_run is worker 0
+  vector<thread> workers;
+  thread_pool_deque *deques;
+
+  // current parallel_for, written before its first range is pushed
+  thread_pool_body body;
+  void *context;
+  int grain;
+  atomic<long> remaining;  // iterations not done yet
+
+  atomic<unsigned> generation;  // incremented for every parallel_for
+  atomic<bool> stop;
+  mutex lock;
+  condition_variable wake;
+};
+
+static thread_pool *pool = NULL;
+static thread_local int worker_id = -1;
+
+bool thread_pool_worker() {
+  return worker_id >= 0;
+}
+
+// Runs ranges, its own first then stolen ones, until the parallel_for is done
+static void thread_pool_work(thread_pool &p, int w) {
+  unsigned victim = w;
+  while (p.remaining.load(memory_order_acquire) > 0) {
+    uint64_t range;
+    bool found = deque_take(p.deques[w], range);
+    for (int i = 1; i < p.threads && !found; i++) {
+      victim = (victim + 1) % p.threads;
+      found = victim != static_cast<unsigned>(w) \
+        && deque_steal(p.deques[victim], range);
+    }
+    if (!found) {
+      sched_yield();
+      continue;
+    }
+    int lo, hi;
+    range_unpack(range, lo, hi);
+    while (hi - lo > p.grain) {
+      int middle = lo + (hi - lo) / 2;
+      deque_push(p.deques[w], range_pack(middle, hi));
+      hi = middle;
+    }
+    p.body(p.context, lo, hi);
+    p.remaining.fetch_sub(hi - lo, memory_order_acq_rel);
+  }
+}
+
+static void thread_pool_main(thread_pool *p, int w) {
+  worker_id = w;
+  // one core per worker, the caller's thread is left to the system
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(w % max(1u, thread::hardware_concurrency()), &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+  unsigned seen = 0;
+  while (true) {
+    int spin = 0;
+    while (p->generation.load(memory_order_acquire) == seen \
+      && !p->stop.load(memory_order_acquire)) {
+      if (++spin < THREAD_POOL_SPIN) {
+        continue;
+      }
+      unique_lock<mutex> guard(p->lock);
+      p->wake.wait(guard, [&]() {
+        return p->generation.load() != seen || p->stop.load();
+      });
+    }
+    if (p->stop.load(memory_order_acquire)) {
+      return;
+    }
+    seen = p->generation.load(memory_order_acquire);
+    thread_pool_work(*p, w);
+  }
+}
+
+static void thread_pool_stop() {
+  {
+    lock_guard<mutex> guard(pool->lock);
+    pool->stop.store(true);
+  }
+  pool->wake.notify_all();
+  for (thread &worker : pool->workers) {
+    worker.join();
+  }
+  delete[] pool->deques;
+  delete pool;
+  pool = NULL;
+}
+
+static void thread_pool_start() {
+  pool = new thread_pool();
+  pool->threads = max(1, omp_get_max_threads());
+  pool->deques = new thread_pool_deque[pool->threads];
+  for (int w = 0; w < pool->threads; w++) {
+    pool->deques[w].top.store(0);
+    pool->deques[w].bottom.store(0);
+  }
+  pool->remaining.store(0);
+  pool->generation.store(0);
+  pool->stop.store(false);
+  for (int w = 1; w < pool->threads; w++) {
+    pool->workers.emplace_back(thread_pool_main, pool, w);
+  }
+  atexit(thread_pool_stop);
+}
+
+void thread_pool_run(
+  int begin, int end, int grain, thread_pool_body body, void *context) {
+  if (pool == NULL) {
+    thread_pool_start();
+  }
+  if (pool->threads == 1) {
+    body(context, begin, end);
+    return;
+  }
+  pool->body = body;
+  pool->context = context;
+  pool->grain = grain;
+  pool->remaining.store(end - begin, memory_order_release);
+  deque_push(pool->deques[0], range_pack(begin, end));
+  {
+    lock_guard<mutex> guard(pool->lock);
+    pool->generation.fetch_add(1, memory_order_release);
+  }
+  pool->wake.notify_all();
+
+  worker_id = 0;
+  thread_pool_work(*pool, 0);
+  worker_id = -1;
+}
@@ -0,0 +1,170 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "headers/trajectory.h"
+
+using namespace std;
+
+// time (int, padded) and cells + 1 offsets, rounded up to 8 bytes
+static size_t trajectory_frame_header(int cells) {
+  return (sizeof(int) * (cells + 3) + 7) / 8 * 8;
+}
+
+bool trajectory_writer_open(
+  trajectory_writer &writer, const char *path,
+  int Particles, double Wall, double height) {
+  writer.file = fopen(path, "wb");
+  if (writer.file == NULL) {
+    return false;
+  }
+  double lower[3] = {-Wall, -Wall, -height}, upper[3] = {Wall, Wall, height};
+  cell_grid_setup(writer.grid, lower, upper, \
+    2.0 * max(Wall, height) / TRAJECTORY_CELLS);
+  writer.records.resize(Particles);
+
+  trajectory_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, TRAJECTORY_MAGIC, 8);
+  header.Particles = Particles;
+  for (int d = 0; d < 3; d++) {
+    header.n[d] = writer.grid.n[d];
+    header.lower[d] = writer.grid.lower[d];
+  }
+  header.inverse_size = writer.grid.inverse_size;
+  fwrite(&header, sizeof(header), 1, writer.file);
+  return true;
+}
+
+void trajectory_writer_frame(
+  trajectory_writer &writer,
+  double *x, double *y, double *z, double *ex, double *ey, double *ez,
+  int Particles, int time) {
+  double *position[3] = {x, y, z};
+  cell_grid_build(writer.grid, position, Particles);
+  for (int i = 0; i < Particles; i++) {
+    int k = writer.grid.particles[i];
+    writer.records[i] = {x[k], y[k], z[k], ex[k], ey[k], ez[k], k, time};
+  }
+
+  int cells = static_cast<int>(writer.grid.cell_start.size()) - 1;
+  vector<int> frame_header(trajectory_frame_header(cells) / sizeof(int), 0);
+  frame_header[0] = time;
+  copy(writer.grid.cell_start.begin(), writer.grid.cell_start.end(), \
+    frame_header.begin() + 2);
+  fwrite(frame_header.data(), sizeof(int), frame_header.size(), writer.file);
+  fwrite(writer.records.data(), sizeof(trajectory_record), Particles, \
+    writer.file);
+}
+
+void trajectory_writer_close(trajectory_writer &writer) {
+  fclose(writer.file);
+}
+
+bool trajectory_reader_open(trajectory_reader &reader, const char *path) {
+  reader.map = NULL;
+  reader.fd = open(path, O_RDONLY);
+  if (reader.fd < 0) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(reader.fd, &status) != 0 \
+    || status.st_size < static_cast<off_t>(sizeof(trajectory_header))) {
+    close(reader.fd);
+    return false;
+  }
+  reader.size = status.st_size;
+  void *map = mmap(NULL, reader.size, PROT_READ, MAP_PRIVATE, reader.fd, 0);
+  if (map == MAP_FAILED) {
+    close(reader.fd);
+    return false;
+  }
+  reader.map = reinterpret_cast<const char*>(map);
+  memcpy(&reader.header, reader.map, sizeof(trajectory_header));
+  if (memcmp(reader.header.magic, TRAJECTORY_MAGIC, 8) != 0) {
+    trajectory_reader_close(reader);
+    return false;
+  }
+  reader.cells = reader.header.n[0] * reader.header.n[1] * reader.header.n[2];
+  reader.frame_header = trajectory_frame_header(reader.cells);
+  reader.frame_size = reader.frame_header \
+    + sizeof(trajectory_record) * reader.header.Particles;
+  // an unfinished last frame is ignored
+  reader.frames = (reader.size - sizeof(trajectory_header)) \
+    / reader.frame_size;
+  // the pages of a query are scattered over the file
+  madvise(map, reader.size, MADV_RANDOM);
+  return true;
+}
+
+// Time of frame f
+static inline int trajectory_time(const trajectory_reader &reader, long f) {
+  return *reinterpret_cast<const int*>(reader.map \
+    + sizeof(trajectory_header) + f * reader.frame_size);
+}
+
+size_t trajectory_query(
+  const trajectory_reader &reader,
+  const double *lower, const double *upper, int t0, int t1,
+  vector<trajectory_record> &records) {
+  // first frame with time >= t0, times are increasing
+  long first = 0, last = reader.frames;
+  while (first < last) {
+    long middle = (first + last) / 2;
+    if (trajectory_time(reader, middle) < t0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+
+  // coarse cells overlapping the box
+  int low[3], high[3];
+  for (int d = 0; d < 3; d++) {
+    double u_low = (lower[d] - reader.header.lower[d]) \
+      * reader.header.inverse_size;
+    double u_high = (upper[d] - reader.header.lower[d]) \
+      * reader.header.inverse_size;
+    low[d] = min(max(static_cast<int>(floor(u_low)), 0), \
+      reader.header.n[d] - 1);
+    high[d] = min(max(static_cast<int>(floor(u_high)), 0), \
+      reader.header.n[d] - 1);
+  }
+
+  size_t found = records.size();
+  for (long f = first; f < reader.frames && trajectory_time(reader, f) <= t1;
+    f++) {
+    const char *frame = reader.map + sizeof(trajectory_header) \
+      + f * reader.frame_size;
+    const int *cell_start = reinterpret_cast<const int*>(frame) + 2;
+    const trajectory_record *frame_records = \
+      reinterpret_cast<const trajectory_record*>(frame + reader.frame_header);
+    for (int c2 = low[2]; c2 <= high[2]; c2++) {
+      for (int c1 = low[1]; c1 <= high[1]; c1++) {
+        // cells along x are contiguous in the records
+        int cell = (c2 * reader.header.n[1] + c1) * reader.header.n[0];
+        for (int i = cell_start[cell + low[0]];
+          i < cell_start[cell + high[0] + 1]; i++) {
+          const trajectory_record &record = frame_records[i];
+          if (record.x >= lower[0] && record.x <= upper[0] \
+            && record.y >= lower[1] && record.y <= upper[1] \
+            && record.z >= lower[2] && record.z <= upper[2]) {
+            records.push_back(record);
+          }
+        }
+      }
+    }
+  }
+  return records.size() - found;
+}
+
+void trajectory_reader_close(trajectory_reader &reader) {
+  if (reader.map != NULL) {
+    munmap(const_cast<char*>(reader.map), reader.size);
+  }
+  close(reader.fd);
+}
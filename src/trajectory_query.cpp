@@ -0,0 +1,47 @@
+/*
+ * Author: Jeremy Vachier
+ * Purpose: Particles of a binary trajectory inside a box over a time window
+ * Language: C++
+ * Date: 2023
+ * Usage: ./trajectory_query.out <trajectory> <x0> <x1> <y0> <y1> <z0> <z1>
+ *   <t0> <t1>, prints the records in the csv format of print_file
+ */
+#include <stdio.h>
+#include <cstdlib>
+#include <vector>
+
+#include "headers/trajectory.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  if (argc != 10) {
+    printf("usage: %s <trajectory> <x0> <x1> <y0> <y1> <z0> <z1> <t0> <t1>\n", \
+      argv[0]);
+    return 0;
+  }
+  trajectory_reader reader;
+  if (!trajectory_reader_open(reader, argv[1])) {
+    printf("cannot read %s\n", argv[1]);
+    return 0;
+  }
+  double lower[3], upper[3];
+  for (int d = 0; d < 3; d++) {
+    lower[d] = atof(argv[2 + 2 * d]);
+    upper[d] = atof(argv[3 + 2 * d]);
+  }
+
+  vector<trajectory_record> records;
+  trajectory_query(
+    reader, lower, upper, atoi(argv[8]), atoi(argv[9]), records);
+
+  printf("Particles,x-position,y-position,z-position, "\
+    "ex-orientation,ey-orientation,ez-orientation,time\n");
+  for (const trajectory_record &record : records) {
+    printf("Particles%d,%lf,%lf,%lf,%lf,%lf,%lf,%d\n", record.particle, \
+      record.x, record.y, record.z, record.ex, record.ey, record.ez, \
+      record.time);
+  }
+  trajectory_reader_close(reader);
+  return 0;
+}
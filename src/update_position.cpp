@@ -1,72 +1,120 @@
+#include <climits>
+
 #include "headers/update_position.h"
 
 using namespace std;
 
-void update_position(
+// One instantiation of the policies on the drivers' arrays
+template <typename Policies>
+static void update_position_instance(
   double *x, double *y, double *z,
-  double *ex, double *ey, double *ez, double prefactor_e,
-  int Particles,
-  double delta, double De, double Dt,
-  double xi_ex, double xi_ey, double xi_ez, double xi_px,
-  double xi_py, double xi_pz, double vs,
+  double *ex, double *ey, double *ez, double *force,
+  double prefactor_e, int Particles,
+  double delta, double vs,
   double prefactor_xi_px, double prefactor_xi_py,
   double prefactor_xi_pz,
   double r, double prefactor_interaction,
-  default_random_engine &generator,
-  normal_distribution<double> &Gaussdistribution,
-  uniform_real_distribution<double> &distribution_e) {
-    double a = 0.0;  // local variable - here check if no conflict elsewhere
-    double norm_e = 0.0, invers_norm_e = 0.0;
-    double F = 0.0, R = 0.0;
+  double r_qs, int N_qs, double vs_qs,
+  int beads_per_chain, const external_field *external,
+  local_time_stepping *substeps, cell_grid<3> &grid,
+  uint64_t seed, int time) {
+    soa_layout layout = {{x, y, z, ex, ey, ez}};
+    update_position_layout<Policies>(
+      layout, force, prefactor_e, Particles, delta, vs,
+      prefactor_xi_px, prefactor_xi_py, prefactor_xi_pz,
+      r, prefactor_interaction, r_qs, N_qs, vs_qs,
+      beads_per_chain, external, substeps, grid, seed, time);
+}
 
-    // First orientation
-#pragma omp parallel for simd
-    for (int k = 0; k < Particles; k++) {
-       xi_ex = distribution_e(generator);
-       xi_ey = distribution_e(generator);
-       xi_ez = distribution_e(generator);
+template <typename Policies>
+static constexpr update_position_variant update_position_variant_of(
+  const char *name) {
+  return {name, Policies::potential::enabled, Policies::quorum::enabled,
+    Policies::bonds::enabled, Policies::noise::enabled,
+    Policies::external::enabled, Policies::flow::enabled,
+    Policies::substeps::enabled, update_position_instance<Policies>};
+}
 
-       // Ito formulation
-       ex[k] = prefactor_e * (ey[k] * xi_ez - xi_ez * ez[k]) - ex[k];
-       ey[k] = prefactor_e * (ex[k] * xi_ez - xi_ex * ez[k]) - ey[k];
-       ez[k] = prefactor_e * (ex[k] * xi_ey - xi_ex * ey[k]) - ez[k];
+const update_position_variant update_position_variants[] = {
+  update_position_variant_of<integrator_policies<
+    no_interaction, no_quorum, no_bonds, counter_noise> >("ideal"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, no_quorum, no_bonds, no_noise> >("athermal"),
+  update_position_variant_of<abp_policies>("abp"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, quorum_sensing, no_bonds, counter_noise> >(
+    "abp_quorum"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, no_quorum, chain_exclusion, counter_noise> >(
+    "abp_chains"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, no_quorum, no_bonds, counter_noise, external_forces> >(
+    "abp_external"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, no_quorum, no_bonds, counter_noise, no_external,
+    poiseuille_flow> >("abp_flow"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, no_quorum, no_bonds, counter_noise, no_external,
+    no_flow, sub_stepping> >("abp_substeps"),
+  update_position_variant_of<integrator_policies<
+    capped_repulsion, quorum_sensing, chain_exclusion, counter_noise,
+    external_forces, poiseuille_flow, sub_stepping> >("abp_full"),
+};
 
-       // Need to normalize the orientaional vector
-       norm_e = sqrt(ex[k] * ex[k] + ey[k] * ey[k] + ez[k] * ez[k]);
-       invers_norm_e = 1.0 / norm_e;
+const int update_position_variant_count = \
+  sizeof(update_position_variants) / sizeof(update_position_variants[0]);
 
-       ex[k] = ex[k] * invers_norm_e;
-       ey[k] = ey[k] * invers_norm_e;
-       ez[k] = ez[k] * invers_norm_e;
+const update_position_variant *update_position_select(
+  double prefactor_e, double prefactor_xi_p, double prefactor_interaction,
+  int N_qs, int beads_per_chain, const external_field *external,
+  const local_time_stepping *substeps) {
+  bool quorum = N_qs != INT_MAX;
+  bool interaction = prefactor_interaction != 0.0 || quorum;
+  bool bonds = interaction && beads_per_chain > 1;
+  bool noise = prefactor_e != 0.0 || prefactor_xi_p != 0.0;
+  bool forces = external_field_active(external);
+  bool flow = external_field_flow(external);
+  bool substep = local_time_stepping_active(substeps);
+  for (int i = 0; i < update_position_variant_count; i++) {
+    const update_position_variant &v = update_position_variants[i];
+    if ((v.interaction || !interaction) && (v.quorum || !quorum) \
+      && (v.bonds || !bonds) && (v.noise || !noise) \
+      && (v.external || !forces) && (v.flow || !flow) \
+      && (v.substeps || !substep)) {
+      return &v;
     }
+  }
+  return &update_position_variants[update_position_variant_count - 1];
+}
 
-  // Second position
-#pragma omp parallel for simd
-    for (int k = 0; k < Particles; k++) {
-      xi_px = Gaussdistribution(generator);
-      xi_py = Gaussdistribution(generator);
-      xi_pz = Gaussdistribution(generator);
-
-      F = 0.0;
-      for (int j = 0; j < Particles; j++) {
-        if (k != j) {  // see how to improved the nested if conditions
-          R = sqrt((x[j] - x[k]) * (x[j] - x[k])\
-            + (y[j] - y[k]) * (y[j] - y[k])\
-            + (z[j] - z[k]) * (z[j] - z[k]));
-          if (R < r) {
-            a = prefactor_interaction / pow(R, 14);
-            if (a > 1.0) {
-              a = 1.0;  // this value needs to be checked
-            }
-            F += a;
-          }
-        }
-      }
-    x[k] = x[k] + vs * ex[k] * delta \
-      + F * x[k] * delta + xi_px * prefactor_xi_px;
-    y[k] = y[k] + vs * ey[k] * delta \
-      + F * y[k] * delta + xi_py * prefactor_xi_py;
-    z[k] = z[k] + vs * ez[k] * delta \
-      + F * z[k] * delta + xi_pz * prefactor_xi_pz;
+const update_position_variant *update_position_find(const char *name) {
+  for (int i = 0; i < update_position_variant_count; i++) {
+    if (strcmp(update_position_variants[i].name, name) == 0) {
+      return &update_position_variants[i];
+    }
   }
+  return NULL;
+}
+
+void update_position(
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, double *force,
+  double prefactor_e, int Particles,
+  double delta, double vs,
+  double prefactor_xi_px, double prefactor_xi_py,
+  double prefactor_xi_pz,
+  double r, double prefactor_interaction,
+  double r_qs, int N_qs, double vs_qs,
+  int beads_per_chain, const external_field *external,
+  local_time_stepping *substeps, cell_grid<3> &grid,
+  uint64_t seed, int time) {
+    double prefactor_xi_p = max(max(abs(prefactor_xi_px), \
+      abs(prefactor_xi_py)), abs(prefactor_xi_pz));
+    update_position_select(
+      prefactor_e, prefactor_xi_p, prefactor_interaction, N_qs,
+      beads_per_chain, external, substeps)->kernel(
+      x, y, z, ex, ey, ez, force, prefactor_e, Particles, delta, vs,
+      prefactor_xi_px, prefactor_xi_py, prefactor_xi_pz,
+      r, prefactor_interaction, r_qs, N_qs, vs_qs,
+      beads_per_chain, external, substeps, grid, seed, time);
 }
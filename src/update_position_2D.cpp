@@ -0,0 +1,49 @@
+#include "headers/update_position_2D.h"
+
+using namespace std;
+
+void update_position_2D(
+  double *x, double *y, double *theta, double *F,
+  double prefactor_e, int Particles,
+  double delta, double vs, double prefactor_xi_p,
+  double r, double prefactor_interaction,
+  cell_grid<2> &grid,
+  uint64_t seed, int time) {
+    double r_squared = r * r;
+    double *position[2] = {x, y};
+    cell_grid_build(grid, position, Particles);
+
+    // First interactions, from the positions at the beginning of the step
+#pragma omp parallel for
+    for (int k = 0; k < Particles; k++) {
+      double F_k = 0.0;
+      cell_grid_for_each_neighbour(grid, k, [&](int j) {
+        double R2 = (x[j] - x[k]) * (x[j] - x[k]) \
+          + (y[j] - y[k]) * (y[j] - y[k]);
+        if (R2 < r_squared) {
+          double R6 = R2 * R2 * R2;
+          F_k += min(prefactor_interaction / (R6 * R6 * R2), 1.0);
+        }
+      });
+      F[k] = F_k;
+    }
+
+  // Second orientation, rotational diffusion on the circle, and position.
+  // The noise is drawn from (seed, time, k), independent of the threads.
+#pragma omp parallel for simd
+    for (int k = 0; k < Particles; k++) {
+      double xi_e = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_ORIENTATION);
+      double xi_px = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_POSITION);
+      double xi_py = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_POSITION + 1);
+
+      theta[k] += prefactor_e * xi_e;
+
+      x[k] = x[k] + vs * cos(theta[k]) * delta \
+        + F[k] * x[k] * delta + xi_px * prefactor_xi_p;
+      y[k] = y[k] + vs * sin(theta[k]) * delta \
+        + F[k] * y[k] * delta + xi_py * prefactor_xi_p;
+    }
+}
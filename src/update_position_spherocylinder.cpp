@@ -0,0 +1,160 @@
+#include "headers/update_position_spherocylinder.h"
+
+using namespace std;
+
+// Magnitude of the WCA force at distance d (repulsive, zero beyond
+// 2^(1/6) sigma), capped at f_max.
+static inline double wca_force(
+  double d, double sigma, double epsilon, double f_max) {
+  double s6 = pow(sigma / d, 6);
+  double f = 24.0 * epsilon * (2.0 * s6 * s6 - s6) / d;
+  f = min(f, f_max);
+  return d < pow(2.0, 1.0 / 6.0) * sigma ? f : 0.0;
+}
+
+void update_position_spherocylinder(
+  double *x, double *y, double *z,
+  double *ex, double *ey, double *ez, double *force,
+  int Particles, double delta, double vs,
+  double prefactor_e, double prefactor_xi_p,
+  double length, double epsilon, int L,
+  double Wall, double height,
+  cell_grid<3> &grid,
+  uint64_t seed, int time) {
+    double half_length = 0.5 * length;
+    double sigma_squared = static_cast<double>(L) * L;
+    double cutoff_squared = pow(2.0, 1.0 / 3.0) * sigma_squared;
+    double f_max = 0.1 * L / delta;  // at most 0.1 L displacement per step
+    double *fx = force, *fy = force + Particles, *fz = force + 2 * Particles;
+    double *tx = force + 3 * Particles, *ty = force + 4 * Particles;
+    double *tz = force + 5 * Particles;
+
+    double *position[3] = {x, y, z};
+    cell_grid_build(grid, position, Particles);
+
+    // First forces and torques, from the state at the beginning of the step
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int k = 0; k < Particles; k++) {
+      double F[3] = {0.0, 0.0, 0.0}, T[3] = {0.0, 0.0, 0.0};
+
+      // neighbours gathered in batches for the vectorised segment kernel
+      double rx[SPHEROCYLINDER_BATCH], ry[SPHEROCYLINDER_BATCH];
+      double rz[SPHEROCYLINDER_BATCH];
+      double jx[SPHEROCYLINDER_BATCH], jy[SPHEROCYLINDER_BATCH];
+      double jz[SPHEROCYLINDER_BATCH];
+      int n = 0;
+      double eix = ex[k], eiy = ey[k], eiz = ez[k];
+      auto batch = [&]() {
+        double Fx = 0.0, Fy = 0.0, Fz = 0.0, Tx = 0.0, Ty = 0.0, Tz = 0.0;
+#pragma omp simd reduction(+:Fx, Fy, Fz, Tx, Ty, Tz)
+        for (int i = 0; i < n; i++) {
+          double lambda, mu;
+          double d2 = segment_distance_squared(
+            rx[i], ry[i], rz[i], eix, eiy, eiz, jx[i], jy[i], jz[i],
+            half_length, lambda, mu);
+          d2 = max(d2, 1e-6 * sigma_squared);
+          // from the closest point of j to the closest point of k
+          double dx = lambda * eix - mu * jx[i] - rx[i];
+          double dy = lambda * eiy - mu * jy[i] - ry[i];
+          double dz = lambda * eiz - mu * jz[i] - rz[i];
+          double s6 = sigma_squared / d2;
+          s6 = s6 * s6 * s6;
+          double f = 24.0 * epsilon * (2.0 * s6 * s6 - s6) / d2;
+          f = min(f, f_max / sqrt(d2));
+          f = d2 < cutoff_squared ? f : 0.0;
+          double px = f * dx, py = f * dy, pz = f * dz;
+          Fx += px;
+          Fy += py;
+          Fz += pz;
+          // torque of the force applied at lambda e
+          Tx += lambda * (eiy * pz - eiz * py);
+          Ty += lambda * (eiz * px - eix * pz);
+          Tz += lambda * (eix * py - eiy * px);
+        }
+        F[0] += Fx;
+        F[1] += Fy;
+        F[2] += Fz;
+        T[0] += Tx;
+        T[1] += Ty;
+        T[2] += Tz;
+        n = 0;
+      };
+      cell_grid_for_each_neighbour(grid, k, [&](int j) {
+        rx[n] = x[j] - x[k];
+        ry[n] = y[j] - y[k];
+        rz[n] = z[j] - z[k];
+        jx[n] = ex[j];
+        jy[n] = ey[j];
+        jz[n] = ez[j];
+        n++;
+        if (n == SPHEROCYLINDER_BATCH) {
+          batch();
+        }
+      });
+      batch();
+
+      // end caps against the side wall and the caps of the cylinder
+      for (int s = -1; s <= 1; s += 2) {
+        double arm[3] = {s * half_length * eix, s * half_length * eiy, \
+          s * half_length * eiz};
+        double tip[3] = {x[k] + arm[0], y[k] + arm[1], z[k] + arm[2]};
+        double W[3] = {0.0, 0.0, 0.0};
+        double rho = sqrt(tip[0] * tip[0] + tip[1] * tip[1]);
+        double f = wca_force(max(Wall - rho, 0.01 * L), 0.5 * L, \
+          epsilon, f_max);
+        if (rho > 0.0) {
+          W[0] -= f * tip[0] / rho;
+          W[1] -= f * tip[1] / rho;
+        }
+        W[2] -= wca_force(max(height - tip[2], 0.01 * L), 0.5 * L, \
+          epsilon, f_max);
+        W[2] += wca_force(max(height + tip[2], 0.01 * L), 0.5 * L, \
+          epsilon, f_max);
+        F[0] += W[0];
+        F[1] += W[1];
+        F[2] += W[2];
+        T[0] += arm[1] * W[2] - arm[2] * W[1];
+        T[1] += arm[2] * W[0] - arm[0] * W[2];
+        T[2] += arm[0] * W[1] - arm[1] * W[0];
+      }
+
+      fx[k] = F[0];
+      fy[k] = F[1];
+      fz[k] = F[2];
+      tx[k] = T[0];
+      ty[k] = T[1];
+      tz[k] = T[2];
+    }
+
+  // Second position and orientation, de = (delta T + sqrt(2 De delta) xi) x e
+#pragma omp parallel for
+    for (int k = 0; k < Particles; k++) {
+      double xi_px = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_POSITION);
+      double xi_py = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_POSITION + 1);
+      double xi_pz = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_POSITION + 2);
+      double xi_ex = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_ORIENTATION);
+      double xi_ey = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_ORIENTATION + 1);
+      double xi_ez = counter_rng_gaussian(
+        seed, time, k, COUNTER_RNG_ORIENTATION + 2);
+
+      x[k] += vs * ex[k] * delta + fx[k] * delta + xi_px * prefactor_xi_p;
+      y[k] += vs * ey[k] * delta + fy[k] * delta + xi_py * prefactor_xi_p;
+      z[k] += vs * ez[k] * delta + fz[k] * delta + xi_pz * prefactor_xi_p;
+
+      double wx = tx[k] * delta + prefactor_e * xi_ex;
+      double wy = ty[k] * delta + prefactor_e * xi_ey;
+      double wz = tz[k] * delta + prefactor_e * xi_ez;
+      double nx = ex[k] + wy * ez[k] - wz * ey[k];
+      double ny = ey[k] + wz * ex[k] - wx * ez[k];
+      double nz = ez[k] + wx * ey[k] - wy * ex[k];
+      double invers_norm_e = 1.0 / sqrt(nx * nx + ny * ny + nz * nz);
+      ex[k] = nx * invers_norm_e;
+      ey[k] = ny * invers_norm_e;
+      ez[k] = nz * invers_norm_e;
+    }
+}
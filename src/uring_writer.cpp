@@ -0,0 +1,263 @@
+#include "headers/uring_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#define URING_BUFFERS 8
+#define URING_BUFFER_SIZE (1 << 20)  // multiple of URING_ALIGNMENT
+#define URING_ALIGNMENT 4096  // O_DIRECT offset, size and address alignment
+
+using namespace std;
+
+struct uring_writer {
+  int fd;
+  int ring_fd;
+
+  // submission ring
+  unsigned *sq_tail, *sq_mask, *sq_array;
+  io_uring_sqe *sqes;
+  // completion ring
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  io_uring_cqe *cqes;
+
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size, sqes_size;
+
+  // registered buffers, the current one is being filled by append
+  char *buffers[URING_BUFFERS];
+  unsigned length[URING_BUFFERS];  // length submitted, 0 when free
+  unsigned written[URING_BUFFERS];  // completed part of the length
+  off_t position[URING_BUFFERS];    // file offset of the buffer
+  int current;
+  size_t fill;
+  int in_flight;
+
+  off_t offset;  // file offset of the next submission
+  off_t size;    // bytes appended, the file is truncated to it on close
+  bool failed;   // a write could not be completed
+};
+
+static void uring_writer_release(uring_writer *writer) {
+  if (writer->sqes != NULL) {
+    munmap(writer->sqes, writer->sqes_size);
+  }
+  if (writer->cq_ring != NULL && writer->cq_ring != writer->sq_ring) {
+    munmap(writer->cq_ring, writer->cq_ring_size);
+  }
+  if (writer->sq_ring != NULL) {
+    munmap(writer->sq_ring, writer->sq_ring_size);
+  }
+  if (writer->ring_fd >= 0) {
+    close(writer->ring_fd);
+  }
+  if (writer->fd >= 0) {
+    close(writer->fd);
+  }
+  for (int i = 0; i < URING_BUFFERS; i++) {
+    free(writer->buffers[i]);
+  }
+  delete writer;
+}
+
+uring_writer *uring_writer_open(const char *path) {
+  uring_writer *writer = new uring_writer();
+  writer->ring_fd = -1;
+  writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+  if (writer->fd < 0) {
+    uring_writer_release(writer);
+    return NULL;
+  }
+
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  writer->ring_fd = syscall(__NR_io_uring_setup, URING_BUFFERS, &params);
+  if (writer->ring_fd < 0) {
+    uring_writer_release(writer);
+    return NULL;
+  }
+
+  writer->sq_ring_size = params.sq_off.array \
+    + params.sq_entries * sizeof(unsigned);
+  writer->cq_ring_size = params.cq_off.cqes \
+    + params.cq_entries * sizeof(io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    writer->sq_ring_size = max(writer->sq_ring_size, writer->cq_ring_size);
+  }
+  writer->sq_ring = mmap(NULL, writer->sq_ring_size, PROT_READ | PROT_WRITE, \
+    MAP_SHARED | MAP_POPULATE, writer->ring_fd, IORING_OFF_SQ_RING);
+  if (writer->sq_ring == MAP_FAILED) {
+    writer->sq_ring = NULL;
+    uring_writer_release(writer);
+    return NULL;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    writer->cq_ring = writer->sq_ring;
+  } else {
+    writer->cq_ring = mmap(NULL, writer->cq_ring_size, \
+      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, \
+      writer->ring_fd, IORING_OFF_CQ_RING);
+    if (writer->cq_ring == MAP_FAILED) {
+      writer->cq_ring = NULL;
+      uring_writer_release(writer);
+      return NULL;
+    }
+  }
+  writer->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(NULL, writer->sqes_size, PROT_READ | PROT_WRITE, \
+    MAP_SHARED | MAP_POPULATE, writer->ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    uring_writer_release(writer);
+    return NULL;
+  }
+  writer->sqes = reinterpret_cast<io_uring_sqe*>(sqes);
+
+  char *sq = reinterpret_cast<char*>(writer->sq_ring);
+  char *cq = reinterpret_cast<char*>(writer->cq_ring);
+  writer->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  writer->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  writer->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  writer->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  writer->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  writer->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  writer->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  // buffer pool, registered once so that the kernel does not map the
+  // pages again at every write
+  iovec iovecs[URING_BUFFERS];
+  for (int i = 0; i < URING_BUFFERS; i++) {
+    writer->buffers[i] = reinterpret_cast<char*> \
+      (aligned_alloc(URING_ALIGNMENT, URING_BUFFER_SIZE));
+    if (writer->buffers[i] == NULL) {
+      uring_writer_release(writer);
+      return NULL;
+    }
+    iovecs[i].iov_base = writer->buffers[i];
+    iovecs[i].iov_len = URING_BUFFER_SIZE;
+  }
+  if (syscall(__NR_io_uring_register, writer->ring_fd, \
+    IORING_REGISTER_BUFFERS, iovecs, URING_BUFFERS) < 0) {
+    uring_writer_release(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+// Queues the part of buffer i not written yet.
+static void uring_writer_queue(uring_writer *writer, int i) {
+  unsigned tail = *writer->sq_tail;
+  unsigned index = tail & *writer->sq_mask;
+  io_uring_sqe *sqe = &writer->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_WRITE_FIXED;
+  sqe->fd = writer->fd;
+  sqe->addr = reinterpret_cast<unsigned long long>(writer->buffers[i] \
+    + writer->written[i]);
+  sqe->len = writer->length[i] - writer->written[i];
+  sqe->off = writer->position[i] + writer->written[i];
+  sqe->buf_index = i;
+  sqe->user_data = i;
+  writer->sq_array[index] = index;
+  __atomic_store_n(writer->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  syscall(__NR_io_uring_enter, writer->ring_fd, 1, 0, 0, NULL, 0);
+}
+
+// Collects the completed writes, waits for at least one if `wait`. A short
+// write is queued again for its remainder, an interrupted one entirely; any
+// other error marks the output as failed.
+static void uring_writer_reap(uring_writer *writer, bool wait) {
+  if (wait) {
+    syscall(__NR_io_uring_enter, writer->ring_fd, 0, 1, \
+      IORING_ENTER_GETEVENTS, NULL, 0);
+  }
+  unsigned head = *writer->cq_head;
+  unsigned tail = __atomic_load_n(writer->cq_tail, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    io_uring_cqe *cqe = &writer->cqes[head & *writer->cq_mask];
+    int i = static_cast<int>(cqe->user_data);
+    int res = cqe->res;
+    head++;
+    if (res == -EAGAIN || res == -EINTR) {
+      uring_writer_queue(writer, i);
+      continue;
+    }
+    if (res > 0) {
+      writer->written[i] += res;
+      if (writer->written[i] < writer->length[i]) {
+        uring_writer_queue(writer, i);
+        continue;
+      }
+    } else {
+      printf("io_uring write failed (%d)\n", res);
+      writer->failed = true;
+    }
+    writer->length[i] = 0;
+    writer->in_flight -= 1;
+  }
+  __atomic_store_n(writer->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Submits the current buffer and moves on to a free one.
+static void uring_writer_submit(uring_writer *writer, unsigned length) {
+  int i = writer->current;
+  writer->length[i] = length;
+  writer->written[i] = 0;
+  writer->position[i] = writer->offset;
+  uring_writer_queue(writer, i);
+  writer->in_flight += 1;
+  writer->offset += length;
+  writer->fill = 0;
+
+  uring_writer_reap(writer, false);
+  while (writer->in_flight == URING_BUFFERS) {
+    uring_writer_reap(writer, true);
+  }
+  for (int j = 0; j < URING_BUFFERS; j++) {
+    if (writer->length[j] == 0) {
+      writer->current = j;
+      break;
+    }
+  }
+}
+
+void uring_writer_append(uring_writer *writer, const char *data, size_t size) {
+  writer->size += size;
+  while (size > 0) {
+    size_t n = min(size, URING_BUFFER_SIZE - writer->fill);
+    memcpy(writer->buffers[writer->current] + writer->fill, data, n);
+    writer->fill += n;
+    data += n;
+    size -= n;
+    if (writer->fill == URING_BUFFER_SIZE) {
+      uring_writer_submit(writer, URING_BUFFER_SIZE);
+    }
+  }
+}
+
+bool uring_writer_close(uring_writer *writer) {
+  // last block padded with zeros, removed by the truncation below
+  if (writer->fill > 0) {
+    size_t padded = (writer->fill + URING_ALIGNMENT - 1) \
+      / URING_ALIGNMENT * URING_ALIGNMENT;
+    memset(writer->buffers[writer->current] + writer->fill, 0, \
+      padded - writer->fill);
+    uring_writer_submit(writer, padded);
+  }
+  while (writer->in_flight > 0) {
+    uring_writer_reap(writer, true);
+  }
+  bool ok = !writer->failed;
+  if (ftruncate(writer->fd, writer->size) != 0) {
+    printf("io_uring output could not be truncated\n");
+    ok = false;
+  }
+  uring_writer_release(writer);
+  return ok;
+}